@@ -5,19 +5,30 @@ in vec2 vUV;
 
 out vec4 FragColor;
 
-uniform sampler2D uTex0;
-uniform int uUseTexture;
-uniform vec3 uCameraPosWS;
-
-uniform samplerCube uShadowCube;
-uniform float uFarPlane;
+// per frame (see UniformBlocks.h)
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 proj;
+    vec4 posWS;
+} uCamera;
 
 // Point light:
-uniform vec3 uLightPosWS;
-uniform vec3 uLightColor;
+layout (std140, binding = 1) uniform Light
+{
+    vec4 posWS;
+    vec4 color;
+    float farPlane;
+} uLight;
+
+// texture units are fixed, no glUniform1i needed
+layout (binding = 0) uniform sampler2D uTex0;
+layout (binding = 1) uniform samplerCube uShadowCube;
 
+// explicit locations so reloads need no lookups (see LIT_* in main.cpp)
+layout (location = 0) uniform int uUseTexture;
 // Debug: draw the light cube as a solid emissive color
-uniform int uIsLight;
+layout (location = 1) uniform int uIsLight;
 
 
 float ShadowPoint(vec3 fragPosWS, vec3 lightPosWS)
@@ -35,7 +46,7 @@ float ShadowPoint(vec3 fragPosWS, vec3 lightPosWS)
     int samples = 20;
 
     // disk radius grows with distance (helps stabilize softness)
-    float diskRadius = 0.01 + (current / uFarPlane) * 0.03;
+    float diskRadius = 0.01 + (current / uLight.farPlane) * 0.03;
 
     vec3 offsets[20] = vec3[](
         vec3( 1, 1, 1), vec3( 1,-1, 1), vec3(-1,-1, 1), vec3(-1, 1, 1),
@@ -47,7 +58,7 @@ float ShadowPoint(vec3 fragPosWS, vec3 lightPosWS)
 
     for (int i = 0; i < samples; i++)
     {
-        float closest = texture(uShadowCube, toLight + offsets[i] * diskRadius).r * uFarPlane;
+        float closest = texture(uShadowCube, toLight + offsets[i] * diskRadius).r * uLight.farPlane;
         if (current - bias > closest)
             shadow += 1.0;
     }
@@ -64,7 +75,7 @@ void main()
     // Draw the light gizmo cube as a flat color (no lighting)
     if (uIsLight != 0)
     {
-        FragColor = vec4(uLightColor, 1.0);
+        FragColor = vec4(uLight.color.rgb, 1.0);
         return;
     }
 
@@ -75,7 +86,7 @@ void main()
     vec3 N = normalize(vNormalWS);
 
     // Point-light vector
-    vec3 Lvec = uLightPosWS - vPosWS;
+    vec3 Lvec = uLight.posWS.xyz - vPosWS;
     float dist = length(Lvec);
     vec3 L = Lvec / max(dist, 0.0001);
 
@@ -84,18 +95,18 @@ void main()
 
     // Diffuse
     float NdotL = max(dot(N, L), 0.0);
-    vec3 diffuse = NdotL * albedo * uLightColor;
+    vec3 diffuse = NdotL * albedo * uLight.color.rgb;
 
     // Ambient
     vec3 ambient = 0.12 * albedo;
 
     // Specular (Blinn-Phong)
-    vec3 V = normalize(uCameraPosWS - vPosWS);
+    vec3 V = normalize(uCamera.posWS.xyz - vPosWS);
     vec3 H = normalize(L + V);
     float spec = pow(max(dot(N, H), 0.0), 64.0);
-    vec3 specular = vec3(0.25) * spec * uLightColor;
+    vec3 specular = vec3(0.25) * spec * uLight.color.rgb;
 
-    float vis = ShadowPoint(vPosWS, uLightPosWS);
+    float vis = ShadowPoint(vPosWS, uLight.posWS.xyz);
 
     vec3 color = ambient + (diffuse + specular) * att * vis;
     FragColor = vec4(color, 1.0);
@@ -1,25 +1,49 @@
 #version 450 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormalOct; // octahedral (see VertexLayout.h)
 layout (location = 2) in vec2 aUV;
 
-uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+// per instance (see InstanceData)
+layout (location = 3) in mat4 aModel;
+#ifndef UNIFORM_SCALE
+layout (location = 7) in mat3 aNormalMat; // inverse transpose of mat3(aModel), computed on the CPU
+#endif
+
+// per frame (see CameraBlock in UniformBlocks.h)
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 proj;
+    vec4 posWS;
+} uCamera;
 
 out vec3 vNormalWS;
 out vec3 vPosWS;
 out vec2 vUV;
 
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return n;
+}
+
 void main()
 {
-    vec4 worldPos = uModel * vec4(aPos, 1.0);
+    vec3 normal = DecodeOctahedral(aNormalOct);
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
     vPosWS = worldPos.xyz;
 
-    // correct normal transform (inverse transpose of model)
-    mat3 normalMat = transpose(inverse(mat3(uModel)));
-    vNormalWS = normalize(normalMat * aNormal);
+#ifdef UNIFORM_SCALE
+    // rotation * uniform scale: the inverse transpose is the same matrix up to scale,
+    // which the normalize removes
+    vNormalWS = normalize(mat3(aModel) * normal);
+#else
+    vNormalWS = normalize(aNormalMat * normal);
+#endif
 
     vUV = aUV;
-    gl_Position = uProj * uView * worldPos;
+    gl_Position = uCamera.proj * uCamera.view * worldPos;
 }
@@ -1,11 +1,16 @@
 #version 450 core
 in vec3 vWorldPos;
 
-uniform vec3  uLightPosWS;
-uniform float uFarPlane;
+// see LightBlock in UniformBlocks.h
+layout (std140, binding = 1) uniform Light
+{
+    vec4 posWS;
+    vec4 color;
+    float farPlane;
+} uLight;
 
 void main()
 {
-    float dist = length(vWorldPos - uLightPosWS);
-    gl_FragDepth = dist / uFarPlane;   // store linear distance in depth
+    float dist = length(vWorldPos - uLight.posWS.xyz);
+    gl_FragDepth = dist / uLight.farPlane;   // store linear distance in depth
 }
@@ -1,14 +1,33 @@
 #version 450 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uModel;
-uniform mat4 uLightVP;
+// per instance (see InstanceData)
+layout (location = 3) in mat4 aModel;
+layout (location = 10) in uint aLayerMask; // cube faces this instance touches
+
+// see ShadowBlock in UniformBlocks.h
+layout (std140, binding = 2) uniform Shadow
+{
+    mat4 faceVP[6];
+} uShadow;
+
+// face being rendered (per-face path: one pass per face)
+layout (location = 0) uniform int uFace;
 
 out vec3 vWorldPos;
 
 void main()
 {
-    vec4 world = uModel * vec4(aPos, 1.0);
+    // not in this face (GPU culling writes the mask): every vertex lands outside the
+    // clip volume, so the whole instance is clipped before rasterization
+    if ((aLayerMask & (1u << uint(uFace))) == 0u)
+    {
+        vWorldPos = vec3(0.0);
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
+    vec4 world = aModel * vec4(aPos, 1.0);
     vWorldPos = world.xyz;
-    gl_Position = uLightVP * world;
-}
\ No newline at end of file
+    gl_Position = uShadow.faceVP[uFace] * world;
+}
@@ -0,0 +1,25 @@
+#version 450 core
+#extension GL_ARB_shader_viewport_layer_array : require
+layout (location = 0) in vec3 aPos;
+
+// per instance (see InstanceData); one instance per (caster, face), single bit set
+layout (location = 3) in mat4 aModel;
+layout (location = 10) in uint aLayerMask;
+
+// see ShadowBlock in UniformBlocks.h
+layout (std140, binding = 2) uniform Shadow
+{
+    mat4 faceVP[6];
+} uShadow;
+
+out vec3 vWorldPos;
+
+void main()
+{
+    int face = findLSB(aLayerMask);
+
+    vec4 world = aModel * vec4(aPos, 1.0);
+    vWorldPos = world.xyz;
+    gl_Position = uShadow.faceVP[face] * world;
+    gl_Layer = face;
+}
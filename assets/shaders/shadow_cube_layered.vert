@@ -0,0 +1,15 @@
+#version 450 core
+layout (location = 0) in vec3 aPos;
+
+// per instance (see InstanceData)
+layout (location = 3) in mat4 aModel;
+layout (location = 10) in uint aLayerMask;
+
+flat out uint vLayerMask;
+
+// world space out; shadow_cube.geom projects into each face
+void main()
+{
+    gl_Position = aModel * vec4(aPos, 1.0);
+    vLayerMask = aLayerMask;
+}
@@ -0,0 +1,126 @@
+#include "AssetWatcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+AssetWatcher::AssetWatcher(const std::string& rootDir)
+{
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+        std::cerr << "[Watch] inotify unavailable, hot reload disabled.\n";
+        return;
+    }
+
+    AddWatchRecursive(std::filesystem::path(rootDir).lexically_normal().string());
+    m_thread = std::thread(&AssetWatcher::ThreadMain, this);
+#else
+    (void)rootDir;
+#endif
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    m_stop = true;
+    if (m_thread.joinable())
+        m_thread.join();
+#ifdef __linux__
+    if (m_fd >= 0)
+        close(m_fd);
+#endif
+}
+
+std::vector<std::string> AssetWatcher::TakeChanges()
+{
+    std::vector<std::string> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changes.swap(m_changes);
+    }
+
+    // editors often write a file several times per save
+    std::sort(changes.begin(), changes.end());
+    changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+    return changes;
+}
+
+void AssetWatcher::AddWatchRecursive(const std::string& dir)
+{
+#ifdef __linux__
+    // written and closed, or moved into place (editors that save via rename)
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    int wd = inotify_add_watch(m_fd, dir.c_str(), mask);
+    if (wd < 0)
+    {
+        std::cerr << "[Watch] Cannot watch " << dir << "\n";
+        return;
+    }
+    m_watchDirs[wd] = dir;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (entry.is_directory(ec))
+            AddWatchRecursive(entry.path().lexically_normal().string());
+    }
+#else
+    (void)dir;
+#endif
+}
+
+void AssetWatcher::ThreadMain()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+
+    while (!m_stop)
+    {
+        // short timeout so the destructor never waits long
+        pollfd pfd{ m_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+
+        ssize_t len = read(m_fd, buffer, sizeof(buffer));
+        if (len <= 0)
+            continue;
+
+        std::vector<std::string> changed;
+        for (char* p = buffer; p < buffer + len; )
+        {
+            const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            auto dir = m_watchDirs.find(ev->wd);
+            if (dir == m_watchDirs.end() || ev->len == 0)
+                continue;
+
+            std::string path = (std::filesystem::path(dir->second) / ev->name).lexically_normal().string();
+            if (ev->mask & IN_ISDIR)
+            {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddWatchRecursive(path);
+            }
+            else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                // IN_CREATE alone: the file isn't written yet, IN_CLOSE_WRITE follows
+                changed.push_back(path);
+            }
+        }
+
+        if (!changed.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_changes.insert(m_changes.end(), changed.begin(), changed.end());
+        }
+    }
+#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches a directory tree for files that were written or moved into place
+// (inotify on Linux, elsewhere it never reports anything). A background thread
+// collects the events; the render thread picks them up with TakeChanges().
+class AssetWatcher
+{
+public:
+    explicit AssetWatcher(const std::string& rootDir);
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    bool IsRunning() const { return m_fd >= 0; }
+
+    // Changed files (normalized paths under rootDir), each reported once
+    // no matter how many events the save produced
+    std::vector<std::string> TakeChanges();
+
+private:
+    void AddWatchRecursive(const std::string& dir);
+    void ThreadMain();
+
+    int m_fd = -1;
+    std::unordered_map<int, std::string> m_watchDirs; // watch descriptor -> directory (watcher thread only after start)
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    std::vector<std::string> m_changes;
+};
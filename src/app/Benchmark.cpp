@@ -0,0 +1,242 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    constexpr int PASS_COUNT = static_cast<int>(BenchPass::Count);
+    const char* PASS_NAMES[PASS_COUNT] = { "shadow_gpu_ms", "lit_gpu_ms" };
+
+    struct Summary
+    {
+        double mean = 0.0, min = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+    };
+
+    // Nearest-rank percentiles over a copy of the values
+    Summary Summarize(std::vector<double> v)
+    {
+        Summary s;
+        if (v.empty()) return s;
+
+        std::sort(v.begin(), v.end());
+        auto rank = [&](double p)
+            {
+                std::size_t i = static_cast<std::size_t>(std::ceil(p * v.size()));
+                return v[std::clamp<std::size_t>(i, 1, v.size()) - 1];
+            };
+
+        for (double x : v) s.mean += x;
+        s.mean /= static_cast<double>(v.size());
+        s.min = v.front();
+        s.max = v.back();
+        s.p50 = rank(0.50);
+        s.p95 = rank(0.95);
+        s.p99 = rank(0.99);
+        return s;
+    }
+
+    void PrintSummary(const char* name, const Summary& s)
+    {
+        std::cout << "  " << name << ": mean " << s.mean << "  p50 " << s.p50
+            << "  p95 " << s.p95 << "  p99 " << s.p99
+            << "  (min " << s.min << ", max " << s.max << ")\n";
+    }
+
+    void JsonSummary(std::ostream& out, const Summary& s)
+    {
+        out << "{ \"mean\": " << s.mean << ", \"min\": " << s.min << ", \"p50\": " << s.p50
+            << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << " }";
+    }
+}
+
+Benchmark::Benchmark(BenchmarkSettings settings)
+    : m_settings(std::move(settings))
+{
+    m_settings.warmupFrames = std::max(m_settings.warmupFrames, 0);
+    m_settings.measuredFrames = std::max(m_settings.measuredFrames, 1);
+
+    m_queries.resize(static_cast<std::size_t>(m_settings.measuredFrames) * PASS_COUNT);
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+
+    m_samples.resize(m_settings.measuredFrames);
+}
+
+Benchmark::~Benchmark()
+{
+    if (!m_queries.empty())
+        glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void Benchmark::CameraAt(float t, glm::vec3& pos, glm::vec3& front)
+{
+    const glm::vec3 target(1.0f, 0.0f, 0.0f);
+    const float angle = 0.25f * t;
+    const float radius = 5.0f + 0.5f * std::sin(0.5f * t);
+
+    pos = target + glm::vec3(radius * std::sin(angle), 1.5f + 0.5f * std::sin(0.3f * t), radius * std::cos(angle));
+    front = glm::normalize(target - pos);
+}
+
+glm::vec3 Benchmark::LightAt(float t)
+{
+    const float angle = 0.7f * t;
+    return glm::vec3(1.0f + 2.0f * std::cos(angle), 1.5f, 2.0f * std::sin(angle));
+}
+
+void Benchmark::BeginFrame()
+{
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::BeginPass(BenchPass pass)
+{
+    if (!IsMeasuring()) return;
+
+    int measured = m_frame - m_settings.warmupFrames;
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[measured * PASS_COUNT + static_cast<int>(pass)]);
+    m_passOpen = true;
+}
+
+void Benchmark::EndPass()
+{
+    if (!m_passOpen) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_passOpen = false;
+}
+
+void Benchmark::EndFrame(const RenderStats& stats)
+{
+    if (IsMeasuring())
+    {
+        auto end = std::chrono::steady_clock::now();
+        FrameSample& sample = m_samples[m_frame - m_settings.warmupFrames];
+        sample.cpuMs = std::chrono::duration<double, std::milli>(end - m_frameStart).count();
+        sample.stats = stats;
+    }
+
+    m_frame++;
+}
+
+bool Benchmark::Finish()
+{
+    int measured = std::clamp(m_frame - m_settings.warmupFrames, 0, m_settings.measuredFrames);
+    m_samples.resize(measured);
+
+    // GL_QUERY_RESULT waits for the GPU, which is fine once the run is over
+    for (int f = 0; f < measured; f++)
+    {
+        for (int p = 0; p < PASS_COUNT; p++)
+        {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(m_queries[f * PASS_COUNT + p], GL_QUERY_RESULT, &ns);
+            m_samples[f].gpuMs[p] = static_cast<double>(ns) / 1.0e6;
+        }
+    }
+
+    std::vector<double> cpu;
+    for (const FrameSample& s : m_samples) cpu.push_back(s.cpuMs);
+
+    std::cout << "[Bench] " << measured << " frames measured after "
+        << m_settings.warmupFrames << " warmup frames\n";
+    PrintSummary("cpu_frame_ms", Summarize(cpu));
+    for (int p = 0; p < PASS_COUNT; p++)
+    {
+        std::vector<double> gpu;
+        for (const FrameSample& s : m_samples) gpu.push_back(s.gpuMs[p]);
+        PrintSummary(PASS_NAMES[p], Summarize(gpu));
+    }
+    if (!m_samples.empty())
+    {
+        const RenderStats& last = m_samples.back().stats;
+        std::cout << "  draw_calls/frame: " << last.drawCalls << ", triangles/frame: " << last.triangles << "\n"
+            << "  camera culled: " << last.cameraCulled << "/" << last.cameraTested
+            << ", shadow culled: " << last.shadowCulled << "/" << last.shadowTested
+            << ", shadow faces drawn: " << last.shadowFaces << "/" << (last.shadowTested * 6)
+            << ", restored from cache: " << last.shadowFacesRestored << "\n"
+            << "  below LOD 0: camera " << last.cameraLodReduced << ", shadow " << last.shadowLodReduced << "\n"
+            << "  GL state calls: " << last.stateCallsIssued << " issued, " << last.stateCallsElided << " elided\n"
+            << "  streamed: " << last.streamBytes / 1024 << " KB, " << last.streamWaits << " fence waits\n";
+    }
+
+    if (m_settings.outPath.empty())
+        return true;
+
+    bool json = m_settings.outPath.size() >= 5 &&
+        m_settings.outPath.compare(m_settings.outPath.size() - 5, 5, ".json") == 0;
+
+    bool ok = json ? WriteJson() : WriteCsv();
+    if (ok)
+        std::cout << "[Bench] Wrote " << m_settings.outPath << "\n";
+    return ok;
+}
+
+bool Benchmark::WriteCsv() const
+{
+    std::ofstream file(m_settings.outPath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open file: " << m_settings.outPath << "\n";
+        return false;
+    }
+
+    file << "frame,cpu_ms";
+    for (const char* name : PASS_NAMES) file << "," << name;
+    file << ",draw_calls,camera_culled,shadow_culled,shadow_faces\n";
+
+    for (std::size_t f = 0; f < m_samples.size(); f++)
+    {
+        const FrameSample& s = m_samples[f];
+        file << f << "," << s.cpuMs;
+        for (double ms : s.gpuMs) file << "," << ms;
+        file << "," << s.stats.drawCalls << "," << s.stats.cameraCulled << "," << s.stats.shadowCulled
+            << "," << s.stats.shadowFaces << "\n";
+    }
+
+    return file.good();
+}
+
+bool Benchmark::WriteJson() const
+{
+    std::ofstream file(m_settings.outPath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open file: " << m_settings.outPath << "\n";
+        return false;
+    }
+
+    std::vector<double> cpu;
+    for (const FrameSample& s : m_samples) cpu.push_back(s.cpuMs);
+
+    file << "{\n  \"warmup_frames\": " << m_settings.warmupFrames
+        << ",\n  \"measured_frames\": " << m_samples.size()
+        << ",\n  \"summary\": {\n    \"cpu_ms\": ";
+    JsonSummary(file, Summarize(cpu));
+    for (int p = 0; p < PASS_COUNT; p++)
+    {
+        std::vector<double> gpu;
+        for (const FrameSample& s : m_samples) gpu.push_back(s.gpuMs[p]);
+        file << ",\n    \"" << PASS_NAMES[p] << "\": ";
+        JsonSummary(file, Summarize(gpu));
+    }
+    file << "\n  },\n  \"frames\": [\n";
+
+    for (std::size_t f = 0; f < m_samples.size(); f++)
+    {
+        const FrameSample& s = m_samples[f];
+        file << "    { \"cpu_ms\": " << s.cpuMs;
+        for (int p = 0; p < PASS_COUNT; p++)
+            file << ", \"" << PASS_NAMES[p] << "\": " << s.gpuMs[p];
+        file << ", \"draw_calls\": " << s.stats.drawCalls
+            << ", \"camera_culled\": " << s.stats.cameraCulled
+            << ", \"shadow_culled\": " << s.stats.shadowCulled
+            << ", \"shadow_faces\": " << s.stats.shadowFaces << " }"
+            << (f + 1 < m_samples.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+
+    return file.good();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../gfx/RenderStats.h"
+
+struct BenchmarkSettings
+{
+    int warmupFrames = 60;
+    int measuredFrames = 600;
+    std::string outPath; // .json -> summary + per-frame arrays, anything else -> per-frame CSV
+};
+
+enum class BenchPass
+{
+    Shadow,
+    Lit,
+    Count
+};
+
+// Drives a fixed camera/light path and records per-frame CPU time, per-pass GPU time
+// (GL_TIME_ELAPSED), draw calls and culling counters. Queries are only read back once the run is over,
+// so measuring never stalls the pipeline.
+class Benchmark
+{
+public:
+    explicit Benchmark(BenchmarkSettings settings);
+    ~Benchmark();
+
+    Benchmark(const Benchmark&) = delete;
+    Benchmark& operator=(const Benchmark&) = delete;
+
+    // Procedural paths (t in seconds): slow orbit around the scene, light circling above
+    static void CameraAt(float t, glm::vec3& pos, glm::vec3& front);
+    static glm::vec3 LightAt(float t);
+
+    int TotalFrames() const { return m_settings.warmupFrames + m_settings.measuredFrames; }
+    bool IsDone() const { return m_frame >= TotalFrames(); }
+
+    void BeginFrame();
+    void BeginPass(BenchPass pass);
+    void EndPass();
+    void EndFrame(const RenderStats& stats);
+
+    // Resolves the GPU queries (blocks) and prints/writes the report
+    bool Finish();
+
+private:
+    struct FrameSample
+    {
+        double cpuMs = 0.0;
+        double gpuMs[static_cast<int>(BenchPass::Count)] = {};
+        RenderStats stats;
+    };
+
+    bool IsMeasuring() const { return m_frame >= m_settings.warmupFrames && !IsDone(); }
+    bool WriteCsv() const;
+    bool WriteJson() const;
+
+    BenchmarkSettings m_settings;
+    int m_frame = 0;
+    bool m_passOpen = false;
+
+    std::chrono::steady_clock::time_point m_frameStart;
+    std::vector<GLuint> m_queries; // measuredFrames * passes, indexed [frame][pass]
+    std::vector<FrameSample> m_samples;
+};
@@ -0,0 +1,185 @@
+#include "HeadlessContext.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static EGLDisplay OpenDisplay()
+{
+    // Prefer Mesa's surfaceless platform: no X/Wayland/DRM device required
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    const char* clientExts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (getPlatformDisplay && clientExts && std::strstr(clientExts, "EGL_MESA_platform_surfaceless"))
+    {
+        EGLDisplay dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (dpy != EGL_NO_DISPLAY)
+            return dpy;
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    Destroy();
+}
+
+bool HeadlessContext::Create(int width, int height)
+{
+    EGLDisplay dpy = OpenDisplay();
+    EGLint major = 0, minor = 0;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor))
+    {
+        std::cerr << "[Headless] Failed to initialize EGL display\n";
+        return false;
+    }
+    m_display = dpy;
+
+    const char* exts = eglQueryString(dpy, EGL_EXTENSIONS);
+    if (!exts || !std::strstr(exts, "EGL_KHR_surfaceless_context"))
+    {
+        std::cerr << "[Headless] EGL_KHR_surfaceless_context not supported\n";
+        Destroy();
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "[Headless] Desktop OpenGL not available through EGL\n";
+        Destroy();
+        return false;
+    }
+
+    // Same version/profile the windowed path asks GLFW for
+    const EGLint ctxAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    // Surfaceless, so no config needed with EGL_KHR_no_config_context; otherwise any
+    // desktop GL config will do (nothing is ever drawn to a surface of it)
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    if (!std::strstr(exts, "EGL_KHR_no_config_context"))
+    {
+        const EGLint configAttribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_SURFACE_TYPE, EGL_DONT_CARE,
+            EGL_NONE
+        };
+        EGLint count = 0;
+        if (!eglChooseConfig(dpy, configAttribs, &config, 1, &count) || count == 0)
+        {
+            std::cerr << "[Headless] EGL_KHR_no_config_context not supported and no OpenGL config found\n";
+            Destroy();
+            return false;
+        }
+    }
+
+    EGLContext ctx = eglCreateContext(dpy, config, EGL_NO_CONTEXT, ctxAttribs);
+    if (ctx == EGL_NO_CONTEXT)
+    {
+        std::cerr << "[Headless] eglCreateContext failed (0x" << std::hex << eglGetError() << std::dec << ")\n";
+        Destroy();
+        return false;
+    }
+    m_context = ctx;
+
+    if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx))
+    {
+        std::cerr << "[Headless] eglMakeCurrent failed\n";
+        Destroy();
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cerr << "[Headless] Failed to init GLAD\n";
+        Destroy();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+
+    glGenRenderbuffers(1, &m_colorRb);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &m_depthRb);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRb);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        std::cerr << "[Headless] Offscreen FBO incomplete!\n";
+        Destroy();
+        return false;
+    }
+
+    return true;
+}
+
+bool HeadlessContext::SaveFramePPM(const std::string& path) const
+{
+    if (m_fbo == 0)
+        return false;
+
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(m_width) * m_height * 3);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open file: " << path << "\n";
+        return false;
+    }
+
+    file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+    // GL rows are bottom-up, PPM is top-down
+    const std::size_t rowBytes = static_cast<std::size_t>(m_width) * 3;
+    for (int y = m_height - 1; y >= 0; y--)
+        file.write(reinterpret_cast<const char*>(pixels.data() + y * rowBytes), rowBytes);
+
+    return file.good();
+}
+
+void HeadlessContext::Destroy()
+{
+    if (m_context)
+    {
+        if (m_fbo != 0) glDeleteFramebuffers(1, &m_fbo);
+        if (m_colorRb != 0) glDeleteRenderbuffers(1, &m_colorRb);
+        if (m_depthRb != 0) glDeleteRenderbuffers(1, &m_depthRb);
+        m_fbo = m_colorRb = m_depthRb = 0;
+
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_display, m_context);
+        m_context = nullptr;
+    }
+
+    if (m_display)
+    {
+        eglTerminate(m_display);
+        m_display = nullptr;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+// Offscreen GL 4.5 core context (EGL, no window/display needed) plus an FBO
+// that stands in for the default framebuffer. Works on Mesa llvmpipe.
+class HeadlessContext
+{
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates the context, makes it current, loads GL and builds the target FBO.
+    // Returns false (and leaves nothing behind) on failure.
+    bool Create(int width, int height);
+
+    // Render target replacing framebuffer 0
+    GLuint Framebuffer() const { return m_fbo; }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // Dumps the color attachment as a binary PPM (P6)
+    bool SaveFramePPM(const std::string& path) const;
+
+private:
+    void Destroy();
+
+    void* m_display = nullptr; // EGLDisplay
+    void* m_context = nullptr; // EGLContext
+
+    GLuint m_fbo = 0;
+    GLuint m_colorRb = 0;
+    GLuint m_depthRb = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
@@ -0,0 +1,59 @@
+#include "Bounds.h"
+
+AABB AABB::Transformed(const glm::mat4& m) const
+{
+    if (IsEmpty())
+        return *this;
+
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extent = (max - min) * 0.5f;
+
+    // world extent = |M3x3| * local extent
+    glm::vec3 c = glm::vec3(m * glm::vec4(center, 1.0f));
+    glm::vec3 e(0.0f);
+    for (int col = 0; col < 3; col++)
+        e += glm::abs(glm::vec3(m[col])) * extent[col];
+
+    AABB out;
+    out.min = c - e;
+    out.max = c + e;
+    return out;
+}
+
+Frustum Frustum::FromViewProj(const glm::mat4& vp)
+{
+    // Gribb/Hartmann: rows of the matrix combined (glm is column-major, so row i = vp[*][i])
+    glm::vec4 row0(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+    glm::vec4 row1(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+    glm::vec4 row2(vp[0][2], vp[1][2], vp[2][2], vp[3][2]);
+    glm::vec4 row3(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+
+    Frustum f;
+    f.planes[0] = row3 + row0; // left
+    f.planes[1] = row3 - row0; // right
+    f.planes[2] = row3 + row1; // bottom
+    f.planes[3] = row3 - row1; // top
+    f.planes[4] = row3 + row2; // near
+    f.planes[5] = row3 - row2; // far
+
+    for (glm::vec4& p : f.planes)
+        p /= glm::length(glm::vec3(p));
+    return f;
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+    if (box.IsEmpty())
+        return false;
+
+    for (const glm::vec4& p : planes)
+    {
+        // corner furthest along the plane normal
+        glm::vec3 v(p.x >= 0.0f ? box.max.x : box.min.x,
+                    p.y >= 0.0f ? box.max.y : box.min.y,
+                    p.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(p), v) + p.w < 0.0f)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Axis-aligned box; default constructed it is empty (min > max)
+struct AABB
+{
+    glm::vec3 min{ 1e30f };
+    glm::vec3 max{ -1e30f };
+
+    bool IsEmpty() const { return min.x > max.x; }
+    void Expand(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+
+    // Box around the 8 transformed corners (center/extent form, no corner loop)
+    AABB Transformed(const glm::mat4& m) const;
+};
+
+// 6 planes (xyz = inward normal, w = distance) pulled out of a view-projection matrix
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    static Frustum FromViewProj(const glm::mat4& viewProj);
+
+    // Conservative: may keep boxes that straddle two planes outside a corner
+    bool Intersects(const AABB& box) const;
+};
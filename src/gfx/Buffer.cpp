@@ -1,10 +1,14 @@
 #include "Buffer.h"
+#include "GLState.h"
 #include <utility> // std::exchange
 
+static std::uint64_t s_nextSerial = 1;
+
 Buffer::Buffer(GLenum target)
-	:	m_target(target)
+	:	m_target(target),
+		m_serial(s_nextSerial++)
 {
-	glGenBuffers(1, &m_id);
+	glCreateBuffers(1, &m_id);
 }
 
 Buffer::~Buffer()
@@ -17,24 +21,69 @@ void Buffer::Destroy()
 	if (m_id != 0)
 	{
 		glDeleteBuffers(1, &m_id);
+		GLState::Get().OnDeleteBuffer(m_id);
 		m_id = 0;
+		m_serial = 0;
+		m_immutable = false;
 	}
 }
 
+Buffer::Buffer(Buffer&& other) noexcept
+	:	m_id(std::exchange(other.m_id, 0)),
+		m_target(other.m_target),
+		m_serial(std::exchange(other.m_serial, 0)),
+		m_immutable(std::exchange(other.m_immutable, false))
+{
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept
+{
+	if (this == &other) return *this;
+	Destroy();
+	m_id = std::exchange(other.m_id, 0);
+	m_target = other.m_target;
+	m_serial = std::exchange(other.m_serial, 0);
+	m_immutable = std::exchange(other.m_immutable, false);
+	return *this;
+}
+
 void Buffer::Bind() const
 {
-	glBindBuffer(m_target, m_id);
+	GLState::Get().BindBuffer(m_target, m_id);
 }
 
 void Buffer::Unbind(GLenum target)
 {
-	glBindBuffer(target, 0);
+	GLState::Get().BindBuffer(target, 0);
 }
 
 void Buffer::SetData(const void* data, std::size_t sizeBytes, GLenum usage) const
 {
-	// Make sure this buffer is bound before uploading
-	Bind();
-	glBufferData(m_target, static_cast<GLsizeiptr>(sizeBytes), data, usage);
+	glNamedBufferData(m_id, static_cast<GLsizeiptr>(sizeBytes), data, usage);
+}
+
+void Buffer::SetStorage(const void* data, std::size_t sizeBytes, GLbitfield flags)
+{
+	if (m_immutable)
+	{
+		// Storage can't be respecified: swap in a new object. Created before the old one is
+		// deleted, so it never gets the old name back.
+		GLuint old = m_id;
+		glCreateBuffers(1, &m_id);
+		m_serial = s_nextSerial++;
+		glDeleteBuffers(1, &old);
+		GLState::Get().OnDeleteBuffer(old);
+	}
+	glNamedBufferStorage(m_id, static_cast<GLsizeiptr>(sizeBytes), data, flags);
+	m_immutable = true;
 }
 
+void Buffer::SetSubData(std::size_t offsetBytes, const void* data, std::size_t sizeBytes) const
+{
+	glNamedBufferSubData(m_id, static_cast<GLintptr>(offsetBytes), static_cast<GLsizeiptr>(sizeBytes), data);
+}
+
+void Buffer::GetSubData(std::size_t offsetBytes, void* data, std::size_t sizeBytes) const
+{
+	glGetNamedBufferSubData(m_id, static_cast<GLintptr>(offsetBytes), static_cast<GLsizeiptr>(sizeBytes), data);
+}
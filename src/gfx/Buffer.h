@@ -1,10 +1,13 @@
 #pragma once
 #include <glad/glad.h>
 #include <cstddef>
+#include <cstdint>
 
 class Buffer
 {
 public:
+    // No GL object until one is moved in
+    Buffer() = default;
     explicit Buffer(GLenum target);
     ~Buffer();
 
@@ -17,14 +20,31 @@ public:
     void Bind() const;
     static void Unbind(GLenum target);
 
+    // Mutable storage (glNamedBufferData), only for streams that orphan their storage on
+    // every refill; everything else uses SetStorage
     void SetData(const void* data, std::size_t sizeBytes, GLenum usage) const;
+    // Immutable storage (glNamedBufferStorage), flags as for glBufferStorage
+    // (GL_DYNAMIC_STORAGE_BIT to allow SetSubData). Calling it again replaces the GL
+    // object: Id() changes and bindings of the old one are gone.
+    void SetStorage(const void* data, std::size_t sizeBytes, GLbitfield flags);
+    // Overwrites part of the existing storage (no reallocation)
+    void SetSubData(std::size_t offsetBytes, const void* data, std::size_t sizeBytes) const;
+    // Reads part of the storage back (waits for the GPU)
+    void GetSubData(std::size_t offsetBytes, void* data, std::size_t sizeBytes) const;
+
+    // None of the calls above bind the buffer (DSA); Bind() only for the draw/pixel targets
 
     GLuint Id() const { return m_id; }
     GLenum Target() const { return m_target; }
+    // Identifies the GL object behind Id(): unlike the name, GL never hands it out again
+    // after a delete, so a cached Serial() can't match a different buffer (0: none)
+    std::uint64_t Serial() const { return m_serial; }
 
 private:
     void Destroy();
 
     GLuint m_id = 0;
     GLenum m_target = 0;
+    std::uint64_t m_serial = 0;
+    bool m_immutable = false;
 };
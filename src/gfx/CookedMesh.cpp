@@ -0,0 +1,145 @@
+#include "CookedMesh.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    constexpr unsigned char IDENTIFIER[12] = { 0xAB, 'M', 'R', 'M', 'S', ' ', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    constexpr std::uint64_t BLOB_ALIGNMENT = 64;
+
+    std::uint64_t Align(std::uint64_t offset)
+    {
+        return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    }
+
+    bool InFile(std::uint64_t offset, std::uint64_t bytes, std::size_t size)
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+}
+
+bool OpenCookedMesh(const std::string& path, MappedFile& file, CookedMesh& mesh)
+{
+    mesh = CookedMesh();
+    if (!file.Open(path))
+        return false;
+
+    const char* data = file.Data();
+    std::size_t size = file.Size();
+    if (size < sizeof(CookedMeshHeader))
+    {
+        std::cerr << "Truncated cooked mesh: " << path << "\n";
+        return false;
+    }
+
+    // The mapping is page aligned, so the header can be read in place
+    const auto* header = reinterpret_cast<const CookedMeshHeader*>(data);
+    if (std::memcmp(header->identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0 || header->version != COOKED_MESH_VERSION)
+    {
+        std::cerr << "Not a cooked mesh (or another version, re-run MeshCook): " << path << "\n";
+        return false;
+    }
+
+    VertexLayout layout;
+    layout.position = static_cast<PositionFormat>(header->positionFormat);
+    layout.uv = static_cast<UvFormat>(header->uvFormat);
+    std::uint64_t indexSize = header->indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+
+    bool ok = header->positionFormat <= static_cast<std::uint32_t>(PositionFormat::Unorm16)
+        && header->uvFormat <= static_cast<std::uint32_t>(UvFormat::Half2)
+        && (header->indexType == GL_UNSIGNED_INT || header->indexType == GL_UNSIGNED_SHORT)
+        && header->positionBytes == std::uint64_t(header->vertexCount) * layout.PositionStride()
+        && header->attributeBytes == std::uint64_t(header->vertexCount) * layout.AttributeStride()
+        && header->indexBytes == std::uint64_t(header->indexCount) * indexSize
+        && InFile(header->positionOffset, header->positionBytes, size)
+        && InFile(header->attributeOffset, header->attributeBytes, size)
+        && InFile(header->indexOffset, header->indexBytes, size)
+        && header->lodCount >= 1 && header->lodCount <= MAX_MESH_LODS
+        && header->lods[0].firstIndex == 0;
+    for (std::uint32_t i = 0; ok && i < header->lodCount; i++)
+    {
+        const MeshLodRange& lod = header->lods[i];
+        ok = lod.indexCount % 3 == 0 && lod.firstIndex <= header->indexCount
+            && lod.indexCount <= header->indexCount - lod.firstIndex;
+    }
+    if (!ok)
+    {
+        std::cerr << "Corrupt cooked mesh: " << path << "\n";
+        return false;
+    }
+
+    PackedMeshView& view = mesh.view;
+    view.layout = layout;
+    view.vertexCount = header->vertexCount;
+    view.indexCount = header->indexCount;
+    view.indexType = header->indexType;
+    view.positions = data + header->positionOffset;
+    view.attributes = data + header->attributeOffset;
+    view.indices = data + header->indexOffset;
+    view.lodCount = header->lodCount;
+    std::copy(header->lods, header->lods + header->lodCount, view.lods);
+    view.dequantize = glm::vec4(header->dequantize[0], header->dequantize[1], header->dequantize[2], header->dequantize[3]);
+    view.bounds.min = glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+    view.bounds.max = glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+    mesh.header = header;
+    return true;
+}
+
+bool WriteCookedMesh(const std::string& path, const PackedMesh& mesh)
+{
+    CookedMeshHeader header;
+    std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    header.vertexCount = mesh.vertexCount;
+    header.indexCount = mesh.indexCount;
+    header.indexType = mesh.indexType;
+    header.lodCount = mesh.lodCount;
+    std::copy(mesh.lods, mesh.lods + MAX_MESH_LODS, header.lods);
+    header.positionFormat = static_cast<std::uint32_t>(mesh.layout.position);
+    header.uvFormat = static_cast<std::uint32_t>(mesh.layout.uv);
+    std::memcpy(header.dequantize, &mesh.dequantize, sizeof(header.dequantize));
+    std::memcpy(header.boundsMin, &mesh.bounds.min, sizeof(header.boundsMin));
+    std::memcpy(header.boundsMax, &mesh.bounds.max, sizeof(header.boundsMax));
+
+    header.positionOffset = Align(sizeof(header));
+    header.positionBytes = mesh.positions.size();
+    header.attributeOffset = Align(header.positionOffset + header.positionBytes);
+    header.attributeBytes = mesh.attributes.size();
+    header.indexOffset = Align(header.attributeOffset + header.attributeBytes);
+    header.indexBytes = mesh.indices.size();
+
+    // temp + rename, as for cooked textures
+    std::string tmpPath = path + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (file)
+        {
+            static const char zeros[BLOB_ALIGNMENT] = {};
+            auto WriteBlob = [&](std::uint64_t offset, const std::vector<unsigned char>& blob)
+                {
+                    file.write(zeros, static_cast<std::streamoff>(offset) - file.tellp());
+                    file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+                };
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            WriteBlob(header.positionOffset, mesh.positions);
+            WriteBlob(header.attributeOffset, mesh.attributes);
+            WriteBlob(header.indexOffset, mesh.indices);
+            ok = static_cast<bool>(file);
+        }
+    }
+
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmpPath, path, ec);
+    if (!ok || ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        std::cerr << "Failed to write cooked mesh: " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "Mesh.h"
+
+// Cooked mesh (.cmesh): a fixed header (layout, counts, dequantization, bounds, blob
+// ranges, LOD table), then the position stream, the normal/uv stream and the indices exactly as
+// the GPU takes them, each 64-byte aligned. Loading maps the file and hands the blobs
+// straight to the buffers: no parsing, no intermediate copies.
+// Little endian, like every platform we build for.
+constexpr const char* COOKED_MESH_EXT = ".cmesh";
+constexpr std::uint32_t COOKED_MESH_VERSION = 3; // 2: VertexLayout streams, 16-bit indices; 3: LODs
+
+struct CookedMeshHeader
+{
+    unsigned char identifier[12];
+    std::uint32_t version = COOKED_MESH_VERSION;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;
+    std::uint32_t indexType = 0;      // GL_UNSIGNED_SHORT / GL_UNSIGNED_INT
+    std::uint32_t positionFormat = 0; // PositionFormat
+    std::uint32_t uvFormat = 0;       // UvFormat
+    float dequantize[4] = {};         // see PackedMeshView
+    float boundsMin[3] = {};
+    float boundsMax[3] = {};
+    std::uint32_t lodCount = 1;
+    // from the start of the file
+    std::uint64_t positionOffset = 0;
+    std::uint64_t positionBytes = 0;
+    std::uint64_t attributeOffset = 0;
+    std::uint64_t attributeBytes = 0;
+    std::uint64_t indexOffset = 0;
+    std::uint64_t indexBytes = 0;
+    MeshLodRange lods[MAX_MESH_LODS]; // into the index blob, LOD 0 first
+    std::uint32_t reserved[4] = {};
+};
+static_assert(sizeof(CookedMeshHeader) == 192, "CookedMeshHeader is part of the file format");
+
+// Points into a mapped .cmesh; valid as long as the MappedFile
+struct CookedMesh
+{
+    const CookedMeshHeader* header = nullptr;
+    PackedMeshView view;
+};
+
+// Maps path into file and checks the header and blob ranges
+bool OpenCookedMesh(const std::string& path, MappedFile& file, CookedMesh& mesh);
+bool WriteCookedMesh(const std::string& path, const PackedMesh& mesh);
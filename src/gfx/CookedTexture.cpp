@@ -0,0 +1,225 @@
+#include "CookedTexture.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // KTX2 uses "\xABKTX 20\xBB\r\n\x1A\n"; same shape, different name since we skip the DFD
+    constexpr unsigned char IDENTIFIER[12] = { 0xAB, 'M', 'R', 'T', 'X', ' ', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // VkFormat values, as KTX2 stores them
+    constexpr std::uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+    constexpr std::uint32_t VK_FORMAT_BC3_UNORM_BLOCK = 137;
+    constexpr std::uint32_t VK_FORMAT_BC7_UNORM_BLOCK = 145;
+
+    struct FileHeader
+    {
+        unsigned char identifier[12];
+        std::uint32_t vkFormat = 0;
+        std::uint32_t typeSize = 1;
+        std::uint32_t pixelWidth = 0;
+        std::uint32_t pixelHeight = 0;
+        std::uint32_t pixelDepth = 0;
+        std::uint32_t layerCount = 0;
+        std::uint32_t faceCount = 1;
+        std::uint32_t levelCount = 0;
+        std::uint32_t supercompressionScheme = 0;
+        // index; all empty here
+        std::uint32_t dfdByteOffset = 0;
+        std::uint32_t dfdByteLength = 0;
+        std::uint32_t kvdByteOffset = 0;
+        std::uint32_t kvdByteLength = 0;
+        std::uint64_t sgdByteOffset = 0;
+        std::uint64_t sgdByteLength = 0;
+    };
+    static_assert(sizeof(FileHeader) == 80, "FileHeader must match the KTX2 header + index");
+
+    struct LevelIndex
+    {
+        std::uint64_t byteOffset = 0;
+        std::uint64_t byteLength = 0;
+        std::uint64_t uncompressedByteLength = 0;
+    };
+
+    std::uint32_t ToVkFormat(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return VK_FORMAT_BC3_UNORM_BLOCK;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM: return VK_FORMAT_BC7_UNORM_BLOCK;
+        default: return 0;
+        }
+    }
+
+    GLenum FromVkFormat(std::uint32_t format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case VK_FORMAT_BC3_UNORM_BLOCK: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case VK_FORMAT_BC7_UNORM_BLOCK: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default: return 0;
+        }
+    }
+
+    std::size_t LevelSize(GLenum format, int width, int height)
+    {
+        return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * CompressedBlockBytes(format);
+    }
+}
+
+unsigned CompressedBlockBytes(GLenum format)
+{
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return 16;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: return 16;
+    default: return 0;
+    }
+}
+
+const char* CompressedFormatName(GLenum format)
+{
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: return "BC7";
+    default: return "unknown";
+    }
+}
+
+bool ReadCookedTexture(const std::string& path, ImageData& image)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cerr << "Failed to load texture: " << path << "\n";
+        return false;
+    }
+
+    std::vector<unsigned char> bytes(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    FileHeader header;
+    if (!file || bytes.size() < sizeof(header))
+    {
+        std::cerr << "Truncated cooked texture: " << path << "\n";
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    GLenum format = FromVkFormat(header.vkFormat);
+    if (std::memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0 || format == 0
+        || header.pixelWidth == 0 || header.pixelHeight == 0 || header.levelCount == 0 || header.levelCount > 32
+        || header.supercompressionScheme != 0)
+    {
+        std::cerr << "Not a cooked texture (or unsupported format): " << path << "\n";
+        return false;
+    }
+
+    std::size_t indexEnd = sizeof(header) + header.levelCount * sizeof(LevelIndex);
+    if (bytes.size() < indexEnd)
+    {
+        std::cerr << "Truncated cooked texture: " << path << "\n";
+        return false;
+    }
+
+    std::vector<ImageLevel> levels(header.levelCount);
+    int width = static_cast<int>(header.pixelWidth);
+    int height = static_cast<int>(header.pixelHeight);
+    for (std::uint32_t i = 0; i < header.levelCount; i++)
+    {
+        LevelIndex index;
+        std::memcpy(&index, bytes.data() + sizeof(header) + i * sizeof(LevelIndex), sizeof(index));
+
+        ImageLevel& level = levels[i];
+        level.width = width;
+        level.height = height;
+        level.offset = static_cast<std::size_t>(index.byteOffset);
+        level.size = static_cast<std::size_t>(index.byteLength);
+
+        if (level.size != LevelSize(format, width, height) || index.byteOffset > bytes.size()
+            || index.byteLength > bytes.size() - index.byteOffset)
+        {
+            std::cerr << "Corrupt level " << i << " in cooked texture: " << path << "\n";
+            return false;
+        }
+
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    image.width = static_cast<int>(header.pixelWidth);
+    image.height = static_cast<int>(header.pixelHeight);
+    image.channels = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 3 : 4;
+    image.format = format;
+    image.pixels = std::move(bytes);
+    image.levels = std::move(levels);
+    return true;
+}
+
+bool WriteCookedTexture(const std::string& path, const ImageData& image)
+{
+    std::uint32_t vkFormat = ToVkFormat(image.format);
+    if (vkFormat == 0 || image.levels.empty())
+        return false;
+
+    FileHeader header;
+    std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    header.vkFormat = vkFormat;
+    header.pixelWidth = static_cast<std::uint32_t>(image.width);
+    header.pixelHeight = static_cast<std::uint32_t>(image.height);
+    header.levelCount = static_cast<std::uint32_t>(image.levels.size());
+
+    // level data right after the index, level 0 first, 16-byte aligned
+    std::vector<LevelIndex> index(image.levels.size());
+    std::uint64_t offset = sizeof(header) + index.size() * sizeof(LevelIndex);
+    for (std::size_t i = 0; i < index.size(); i++)
+    {
+        offset = (offset + 15) & ~std::uint64_t(15);
+        index[i].byteOffset = offset;
+        index[i].byteLength = image.levels[i].size;
+        index[i].uncompressedByteLength = image.levels[i].size;
+        offset += image.levels[i].size;
+    }
+
+    // temp + rename so a running app watching the file never reads half of it
+    std::string tmpPath = path + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (file)
+        {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(LevelIndex)));
+            for (std::size_t i = 0; i < index.size(); i++)
+            {
+                static const char zeros[16] = {};
+                std::streamoff pad = static_cast<std::streamoff>(index[i].byteOffset) - file.tellp();
+                file.write(zeros, pad);
+                file.write(reinterpret_cast<const char*>(image.LevelData(static_cast<int>(i))),
+                    static_cast<std::streamsize>(image.levels[i].size));
+            }
+            ok = static_cast<bool>(file);
+        }
+    }
+
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmpPath, path, ec);
+    if (!ok || ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        std::cerr << "Failed to write cooked texture: " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include "ImageData.h"
+
+// Block-compressed formats the texture cook writes (S3TC is an extension, BPTC is core 4.2)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+// Cooked texture (.ctex): the KTX2 header and level index layout (vkFormat, size,
+// levelCount, then byteOffset/byteLength per level, level 0 first) with our own
+// identifier and no data format descriptor or key/value data. Every level of the
+// mip chain is stored, as 4x4 blocks in GL row order (bottom row first).
+// Formats: BC1 (opaque), BC3 and BC7.
+constexpr const char* COOKED_TEXTURE_EXT = ".ctex";
+
+// Bytes per 4x4 block, 0 for formats we don't cook
+unsigned CompressedBlockBytes(GLenum format);
+// "BC1", "BC3", "BC7" (logs and the cook tool)
+const char* CompressedFormatName(GLenum format);
+
+// No GL calls, safe on any thread: fills image.format, levels and pixels (the
+// whole file; levels point into it)
+bool ReadCookedTexture(const std::string& path, ImageData& image);
+// image must be compressed, with level 0 first and every level's size consistent
+bool WriteCookedTexture(const std::string& path, const ImageData& image);
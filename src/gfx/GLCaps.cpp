@@ -0,0 +1,49 @@
+#include "GLCaps.h"
+#include "CookedTexture.h"
+#include <string>
+#include <unordered_set>
+
+bool HasGLExtension(const char* name)
+{
+    static std::unordered_set<std::string> extensions = []()
+        {
+            std::unordered_set<std::string> set;
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+                set.insert(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+            return set;
+        }();
+
+    return extensions.count(name) != 0;
+}
+
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+float MaxTextureAnisotropy()
+{
+    static float maxAnisotropy = []()
+        {
+            float value = 1.0f;
+            if (HasGLExtension("GL_EXT_texture_filter_anisotropic") || HasGLExtension("GL_ARB_texture_filter_anisotropic"))
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &value);
+            return value;
+        }();
+    return maxAnisotropy;
+}
+
+bool IsCompressedFormatSupported(GLenum format)
+{
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return HasGLExtension("GL_EXT_texture_compression_s3tc");
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        return true; // core since 4.2
+    default:
+        return false;
+    }
+}
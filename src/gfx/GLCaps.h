@@ -0,0 +1,11 @@
+#pragma once
+#include <glad/glad.h>
+
+// True if the current context exposes the extension (list is read once and cached)
+bool HasGLExtension(const char* name);
+
+// Largest GL_TEXTURE_MAX_ANISOTROPY the driver takes (queried once), 1 without anisotropic filtering
+float MaxTextureAnisotropy();
+
+// Block-compressed formats the texture cook writes (see CookedTexture.h)
+bool IsCompressedFormatSupported(GLenum format);
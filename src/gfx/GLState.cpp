@@ -0,0 +1,173 @@
+#include "GLState.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <iterator>
+
+GLState& GLState::Get()
+{
+    static GLState state;
+    return state;
+}
+
+int GLState::BufferSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:             return 0;
+    case GL_UNIFORM_BUFFER:           return 1;
+    case GL_SHADER_STORAGE_BUFFER:    return 2;
+    case GL_DRAW_INDIRECT_BUFFER:     return 3;
+    case GL_DISPATCH_INDIRECT_BUFFER: return 4;
+    case GL_COPY_READ_BUFFER:         return 5;
+    case GL_COPY_WRITE_BUFFER:        return 6;
+    case GL_PIXEL_PACK_BUFFER:        return 7;
+    case GL_PIXEL_UNPACK_BUFFER:      return 8;
+    default:                          return -1;
+    }
+}
+
+int GLState::IndexedSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_UNIFORM_BUFFER:        return 0;
+    case GL_SHADER_STORAGE_BUFFER: return 1;
+    default:                       return -1;
+    }
+}
+
+int GLState::TextureSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:       return 0;
+    case GL_TEXTURE_CUBE_MAP: return 1;
+    default:                  return -1;
+    }
+}
+
+bool GLState::Changes(GLuint& cached, GLuint value)
+{
+    RenderStats& stats = GetRenderStats();
+    if (cached == value)
+    {
+        stats.stateCallsElided++;
+        return false;
+    }
+    cached = value;
+    stats.stateCallsIssued++;
+    return true;
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = BufferSlot(target);
+    if (slot < 0)
+    {
+        GetRenderStats().stateCallsIssued++;
+        glBindBuffer(target, buffer);
+    }
+    else if (Changes(m_buffers[slot], buffer))
+        glBindBuffer(target, buffer);
+}
+
+void GLState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    int slot = IndexedSlot(target);
+    if (slot < 0 || index >= INDEXED_SLOTS)
+    {
+        GetRenderStats().stateCallsIssued++;
+        glBindBufferBase(target, index, buffer);
+    }
+    else if (Changes(m_indexed[slot][index], buffer))
+        glBindBufferBase(target, index, buffer);
+    else
+        return;
+
+    int generic = BufferSlot(target);
+    if (generic >= 0)
+        m_buffers[generic] = buffer;
+}
+
+void GLState::BindVertexArray(GLuint vao)
+{
+    if (!Changes(m_vao, vao))
+        return;
+    glBindVertexArray(vao);
+    GetRenderStats().vertexArrayBinds++;
+}
+
+void GLState::UseProgram(GLuint program)
+{
+    if (Changes(m_program, program))
+        glUseProgram(program);
+}
+
+void GLState::ActiveTexture(GLuint unit)
+{
+    if (Changes(m_activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::BindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = TextureSlot(target);
+    if (slot < 0 || unit >= TEXTURE_UNITS)
+    {
+        ActiveTexture(unit);
+        GetRenderStats().stateCallsIssued++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (!Changes(m_textures[unit][slot], texture))
+        return;
+    if (texture != 0)
+    {
+        // binds to the texture's own target on that unit
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+    // glBindTextureUnit(unit, 0) would clear every target of the unit
+    ActiveTexture(unit);
+    glBindTexture(target, 0);
+}
+
+void GLState::OnDeleteBuffer(GLuint buffer)
+{
+    // GL resets every binding of a deleted buffer in this context to 0
+    std::replace(std::begin(m_buffers), std::end(m_buffers), buffer, 0u);
+    for (auto& slots : m_indexed)
+        std::replace(std::begin(slots), std::end(slots), buffer, 0u);
+}
+
+void GLState::OnDeleteVertexArray(GLuint vao)
+{
+    if (m_vao == vao)
+        m_vao = 0;
+}
+
+void GLState::OnDeleteProgram(GLuint program)
+{
+    // stays in use until replaced, but its name may come back for a new program
+    if (m_program == program)
+        m_program = UNKNOWN;
+}
+
+void GLState::OnDeleteTexture(GLuint texture)
+{
+    for (auto& unit : m_textures)
+        std::replace(std::begin(unit), std::end(unit), texture, 0u);
+}
+
+void GLState::Invalidate()
+{
+    std::fill(std::begin(m_buffers), std::end(m_buffers), UNKNOWN);
+    for (auto& slots : m_indexed)
+        std::fill(std::begin(slots), std::end(slots), UNKNOWN);
+    m_vao = UNKNOWN;
+    m_program = UNKNOWN;
+    m_activeUnit = UNKNOWN;
+    for (auto& unit : m_textures)
+        std::fill(std::begin(unit), std::end(unit), UNKNOWN);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <glad/glad.h>
+
+// Shadow copy of the context's bindings: buffer targets (generic and indexed
+// uniform/storage slots), the VAO, the program, the active texture unit and the 2D /
+// cube texture of each unit. A bind that would not change anything is skipped.
+// The element array binding is not tracked: it is VAO state, and VertexArray sets it
+// with DSA without binding anything. Every wrapper in src/gfx binds through here.
+// Code that binds behind its back (or a new context) must call Invalidate(). GL
+// unbinds deleted objects and recycles their names, so deletions are reported through
+// the OnDelete* calls. Issued / elided calls are counted in RenderStats.
+class GLState
+{
+public:
+    static GLState& Get();
+
+    GLState(const GLState&) = delete;
+    GLState& operator=(const GLState&) = delete;
+
+    void BindBuffer(GLenum target, GLuint buffer);
+    // Also sets the generic binding of target, as glBindBufferBase does
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void BindVertexArray(GLuint vao);
+    void UseProgram(GLuint program);
+    void ActiveTexture(GLuint unit);
+    // glBindTextureUnit (no active unit switch); unbinding (0) goes through the active unit
+    void BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    void OnDeleteBuffer(GLuint buffer);
+    void OnDeleteVertexArray(GLuint vao);
+    void OnDeleteProgram(GLuint program);
+    void OnDeleteTexture(GLuint texture);
+
+    // Forget everything: the next bind of each kind is issued
+    void Invalidate();
+
+private:
+    GLState() { Invalidate(); }
+
+    static constexpr GLuint UNKNOWN = ~0u;
+    static constexpr int BUFFER_TARGETS = 9;
+    static constexpr int INDEXED_SLOTS = 16; // per indexed target (uniform, storage)
+    static constexpr int TEXTURE_UNITS = 32;
+    static constexpr int TEXTURE_TARGETS = 2; // 2D, cube map
+
+    static int BufferSlot(GLenum target);
+    static int IndexedSlot(GLenum target);
+    static int TextureSlot(GLenum target);
+    // True (and cached := value) if the call has to go out; counts either way
+    static bool Changes(GLuint& cached, GLuint value);
+
+    GLuint m_buffers[BUFFER_TARGETS];
+    GLuint m_indexed[2][INDEXED_SLOTS];
+    GLuint m_vao;
+    GLuint m_program;
+    GLuint m_activeUnit;
+    GLuint m_textures[TEXTURE_UNITS][TEXTURE_TARGETS];
+};
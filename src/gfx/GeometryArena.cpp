@@ -0,0 +1,321 @@
+#include "GeometryArena.h"
+#include "InstanceBatcher.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(std::size_t capacity)
+    : m_capacity(capacity), m_freeSize(capacity)
+{
+    if (capacity > 0)
+        m_free.emplace(0, capacity);
+}
+
+std::size_t RangeAllocator::Allocate(std::size_t size, std::size_t alignment)
+{
+    if (size == 0)
+        return INVALID;
+
+    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        const std::size_t begin = it->first, end = it->first + it->second;
+        const std::size_t offset = (begin + alignment - 1) / alignment * alignment;
+        if (offset + size > end)
+            continue;
+
+        m_free.erase(it);
+        if (offset > begin)
+            m_free.emplace(begin, offset - begin); // alignment padding stays free
+        if (offset + size < end)
+            m_free.emplace(offset + size, end - offset - size);
+        m_freeSize -= size;
+        return offset;
+    }
+    return INVALID;
+}
+
+void RangeAllocator::Free(std::size_t offset, std::size_t size)
+{
+    if (size == 0)
+        return;
+    m_freeSize += size;
+
+    auto next = m_free.lower_bound(offset);
+    if (next != m_free.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            m_free.erase(prev);
+        }
+    }
+    if (next != m_free.end() && offset + size == next->first)
+    {
+        size += next->second;
+        m_free.erase(next);
+    }
+    m_free.emplace(offset, size);
+}
+
+GeometryArena& GeometryArena::Get()
+{
+    static GeometryArena arena;
+    return arena;
+}
+
+GeometryArena::Pool& GeometryArena::PoolFor(const VertexLayout& layout)
+{
+    for (auto& pool : m_pools)
+    {
+        if (pool->layout == layout)
+            return *pool;
+    }
+
+    m_pools.push_back(std::make_unique<Pool>());
+    Pool& pool = *m_pools.back();
+    pool.layout = layout;
+    SetAttributeFormats(pool);
+    Repack(pool, INITIAL_VERTICES, INITIAL_INDEX_BYTES);
+    return pool;
+}
+
+GeometryHandle GeometryArena::Allocate(const PackedMeshView& mesh)
+{
+    const VertexLayout& layout = mesh.layout;
+    const std::size_t uploadBytes = std::size_t(mesh.indexCount) * (mesh.indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+    // whole words: no alignment padding between ranges, so compaction frees all of FreeSize()
+    const std::size_t indexBytes = (uploadBytes + 3) & ~std::size_t(3);
+    if (mesh.vertexCount == 0 || indexBytes == 0)
+        return 0;
+
+    Pool& pool = PoolFor(layout);
+    std::size_t baseVertex = pool.vertices.Allocate(mesh.vertexCount);
+    std::size_t indexOffset = pool.indexBytes.Allocate(indexBytes, 4);
+    if (baseVertex == RangeAllocator::INVALID || indexOffset == RangeAllocator::INVALID)
+    {
+        if (baseVertex != RangeAllocator::INVALID)
+            pool.vertices.Free(baseVertex, mesh.vertexCount);
+        if (indexOffset != RangeAllocator::INVALID)
+            pool.indexBytes.Free(indexOffset, indexBytes);
+
+        // compacting is enough when the free space is only fragmented; otherwise grow
+        auto Capacity = [](const RangeAllocator& a, std::size_t need)
+            {
+                if (a.FreeSize() >= need)
+                    return a.Capacity();
+                return std::max(a.Capacity() * 2, a.Capacity() - a.FreeSize() + need);
+            };
+        Repack(pool, Capacity(pool.vertices, mesh.vertexCount), Capacity(pool.indexBytes, indexBytes));
+        baseVertex = pool.vertices.Allocate(mesh.vertexCount);
+        indexOffset = pool.indexBytes.Allocate(indexBytes, 4);
+        if (baseVertex == RangeAllocator::INVALID || indexOffset == RangeAllocator::INVALID)
+        {
+            std::cerr << "GeometryArena: no room for " << mesh.vertexCount << " vertices after repacking\n";
+            return 0;
+        }
+    }
+
+    GeometryHandle handle;
+    if (!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<GeometryHandle>(m_ranges.size());
+        m_ranges.emplace_back();
+        m_live.push_back(0);
+    }
+
+    GeometryRange& range = m_ranges[handle];
+    range.layout = layout;
+    range.baseVertex = static_cast<GLint>(baseVertex);
+    range.vertexCount = mesh.vertexCount;
+    range.indexOffset = indexOffset;
+    range.indexBytes = indexBytes;
+    m_live[handle] = 1;
+
+    pool.positions.SetSubData(baseVertex * layout.PositionStride(), mesh.positions, mesh.vertexCount * layout.PositionStride());
+    pool.attributes.SetSubData(baseVertex * layout.AttributeStride(), mesh.attributes, mesh.vertexCount * layout.AttributeStride());
+    pool.indices.SetSubData(indexOffset, mesh.indices, uploadBytes);
+    return handle;
+}
+
+void GeometryArena::Free(GeometryHandle handle)
+{
+    if (handle == 0 || handle >= m_ranges.size() || !m_live[handle])
+        return;
+
+    const GeometryRange& range = m_ranges[handle];
+    Pool& pool = PoolFor(range.layout);
+    pool.vertices.Free(static_cast<std::size_t>(range.baseVertex), range.vertexCount);
+    pool.indexBytes.Free(range.indexOffset, range.indexBytes);
+
+    m_ranges[handle] = GeometryRange{};
+    m_live[handle] = 0;
+    m_freeHandles.push_back(handle);
+}
+
+bool GeometryArena::UpdateVertices(GeometryHandle handle, const std::function<void(void* positions, void* attributes)>& fill)
+{
+    if (handle == 0 || handle >= m_ranges.size() || !m_live[handle])
+        return false;
+
+    const GeometryRange& range = m_ranges[handle];
+    Pool& pool = PoolFor(range.layout);
+    const std::size_t positionBytes = range.vertexCount * range.layout.PositionStride();
+    const std::size_t attributeBytes = range.vertexCount * range.layout.AttributeStride();
+
+    if (!m_staging)
+        m_staging = std::make_unique<StreamBuffer>(GL_COPY_READ_BUFFER, std::size_t(1) << 20);
+    StreamAllocation staging = m_staging->Allocate(positionBytes + attributeBytes);
+    if (staging.data == nullptr)
+        return false;
+    fill(staging.data, staging.data + positionBytes);
+
+    // coherent mapping: the writes are visible to commands issued after them
+    glCopyNamedBufferSubData(m_staging->Id(), pool.positions.Id(), static_cast<GLintptr>(staging.offset),
+        static_cast<GLintptr>(range.baseVertex * range.layout.PositionStride()), static_cast<GLsizeiptr>(positionBytes));
+    glCopyNamedBufferSubData(m_staging->Id(), pool.attributes.Id(), static_cast<GLintptr>(staging.offset + positionBytes),
+        static_cast<GLintptr>(range.baseVertex * range.layout.AttributeStride()), static_cast<GLsizeiptr>(attributeBytes));
+    return true;
+}
+
+void GeometryArena::Repack(Pool& pool, std::size_t vertexCapacity, std::size_t indexCapacity)
+{
+    const VertexLayout& layout = pool.layout;
+    Buffer positions(GL_COPY_WRITE_BUFFER);
+    Buffer attributes(GL_COPY_WRITE_BUFFER);
+    Buffer indices(GL_COPY_WRITE_BUFFER);
+    positions.SetStorage(nullptr, vertexCapacity * layout.PositionStride(), GL_DYNAMIC_STORAGE_BIT);
+    attributes.SetStorage(nullptr, vertexCapacity * layout.AttributeStride(), GL_DYNAMIC_STORAGE_BIT);
+    indices.SetStorage(nullptr, indexCapacity, GL_DYNAMIC_STORAGE_BIT);
+
+    RangeAllocator vertexAlloc(vertexCapacity);
+    RangeAllocator indexAlloc(indexCapacity);
+
+    // live ranges of this pool in their current order, so the copies stay sequential
+    std::vector<GeometryHandle> members;
+    for (GeometryHandle h = 1; h < m_ranges.size(); h++)
+    {
+        if (m_live[h] && m_ranges[h].layout == layout)
+            members.push_back(h);
+    }
+    std::sort(members.begin(), members.end(),
+        [&](GeometryHandle a, GeometryHandle b) { return m_ranges[a].baseVertex < m_ranges[b].baseVertex; });
+
+    auto Copy = [](const Buffer& from, const Buffer& to, std::size_t src, std::size_t dst, std::size_t bytes)
+        {
+            glCopyNamedBufferSubData(from.Id(), to.Id(),
+                static_cast<GLintptr>(src), static_cast<GLintptr>(dst), static_cast<GLsizeiptr>(bytes));
+        };
+
+    for (GeometryHandle h : members)
+    {
+        GeometryRange& range = m_ranges[h];
+        std::size_t baseVertex = vertexAlloc.Allocate(range.vertexCount);
+        std::size_t indexOffset = indexAlloc.Allocate(range.indexBytes, 4);
+
+        Copy(pool.positions, positions, range.baseVertex * layout.PositionStride(),
+            baseVertex * layout.PositionStride(), range.vertexCount * layout.PositionStride());
+        Copy(pool.attributes, attributes, range.baseVertex * layout.AttributeStride(),
+            baseVertex * layout.AttributeStride(), range.vertexCount * layout.AttributeStride());
+        Copy(pool.indices, indices, range.indexOffset, indexOffset, range.indexBytes);
+
+        range.baseVertex = static_cast<GLint>(baseVertex);
+        range.indexOffset = indexOffset;
+    }
+
+    pool.positions = std::move(positions);
+    pool.attributes = std::move(attributes);
+    pool.indices = std::move(indices);
+    pool.vertices = vertexAlloc;
+    pool.indexBytes = indexAlloc;
+    PointVertexStreams(pool);
+    m_repacks++;
+}
+
+void GeometryArena::PointVertexStreams(Pool& pool)
+{
+    const VertexLayout& layout = pool.layout;
+    const VertexArray& vao = pool.vao;
+    vao.SetVertexBuffer(POSITION_BINDING, pool.positions.Id(), 0, static_cast<GLsizei>(layout.PositionStride()));
+    vao.SetVertexBuffer(ATTRIBUTE_BINDING, pool.attributes.Id(), 0, static_cast<GLsizei>(layout.AttributeStride()));
+    vao.SetElementBuffer(pool.indices.Id());
+}
+
+void GeometryArena::SetAttributeFormats(Pool& pool)
+{
+    const VertexLayout& layout = pool.layout;
+    const VertexArray& vao = pool.vao;
+    switch (layout.position)
+    {
+    case PositionFormat::Float3: vao.SetAttribute(0, POSITION_BINDING, 3, GL_FLOAT, GL_FALSE, 0); break;
+    case PositionFormat::Half3: vao.SetAttribute(0, POSITION_BINDING, 3, GL_HALF_FLOAT, GL_FALSE, 0); break;
+    case PositionFormat::Unorm16: vao.SetAttribute(0, POSITION_BINDING, 3, GL_UNSIGNED_SHORT, GL_TRUE, 0); break;
+    }
+    vao.SetAttribute(1, ATTRIBUTE_BINDING, 2, GL_SHORT, GL_TRUE, 0); // octahedral normal
+    vao.SetAttribute(2, ATTRIBUTE_BINDING, 2, layout.uv == UvFormat::Float2 ? GL_FLOAT : GL_HALF_FLOAT, GL_FALSE, 4);
+
+    // Per-instance layout: model mat4 (3..6), normal matrix as 3 padded columns (7..9),
+    // layer mask (10)
+    for (GLuint c = 0; c < 4; c++)
+        vao.SetAttribute(3 + c, INSTANCE_BINDING, 4, GL_FLOAT, GL_FALSE, offsetof(InstanceData, model) + c * sizeof(glm::vec4));
+    for (GLuint c = 0; c < 3; c++)
+        vao.SetAttribute(7 + c, INSTANCE_BINDING, 3, GL_FLOAT, GL_FALSE, offsetof(InstanceData, normal) + c * sizeof(glm::vec4));
+    vao.SetAttributeI(10, INSTANCE_BINDING, 1, GL_UNSIGNED_INT, offsetof(InstanceData, layerMask));
+    vao.SetBindingDivisor(INSTANCE_BINDING, 1);
+}
+
+void GeometryArena::Bind(const VertexLayout& layout)
+{
+    PoolFor(layout).vao.Bind();
+}
+
+void GeometryArena::Bind(const VertexLayout& layout, const Buffer& instances)
+{
+    Pool& pool = PoolFor(layout);
+    // by serial, not name: a deleted stream's name can come back for another buffer
+    if (pool.instanceBuffer != instances.Serial())
+    {
+        // the formats stay: only the buffer behind the instance binding changes
+        pool.vao.SetVertexBuffer(INSTANCE_BINDING, instances.Id(), 0, sizeof(InstanceData));
+        pool.instanceBuffer = instances.Serial();
+    }
+    pool.vao.Bind();
+}
+
+void GeometryArena::Defragment()
+{
+    for (auto& pool : m_pools)
+        Repack(*pool, pool->vertices.Capacity(), pool->indexBytes.Capacity());
+}
+
+GeometryStats GeometryArena::Stats() const
+{
+    GeometryStats stats;
+    stats.pools = static_cast<std::uint32_t>(m_pools.size());
+    for (const auto& pool : m_pools)
+    {
+        const std::size_t vertexBytes = pool->layout.VertexBytes();
+        stats.capacityBytes += pool->vertices.Capacity() * vertexBytes + pool->indexBytes.Capacity();
+        stats.usedBytes += (pool->vertices.Capacity() - pool->vertices.FreeSize()) * vertexBytes
+            + pool->indexBytes.Capacity() - pool->indexBytes.FreeSize();
+    }
+    stats.meshes = static_cast<std::uint32_t>(std::count(m_live.begin(), m_live.end(), std::uint8_t(1)));
+    stats.repacks = m_repacks;
+    return stats;
+}
+
+void GeometryArena::Shutdown()
+{
+    VertexArray::Unbind();
+    m_pools.clear();
+    m_ranges.assign(1, GeometryRange{});
+    m_live.assign(1, 0);
+    m_freeHandles.clear();
+    m_staging.reset();
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Buffer.h"
+#include "StreamBuffer.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+
+// First-fit offset allocator over [0, capacity); freed ranges merge with their neighbours
+class RangeAllocator
+{
+public:
+    static constexpr std::size_t INVALID = ~std::size_t(0);
+
+    explicit RangeAllocator(std::size_t capacity = 0);
+
+    // INVALID when no free range fits (FreeSize() may still be enough: fragmentation)
+    std::size_t Allocate(std::size_t size, std::size_t alignment = 1);
+    void Free(std::size_t offset, std::size_t size);
+
+    std::size_t Capacity() const { return m_capacity; }
+    std::size_t FreeSize() const { return m_freeSize; }
+
+private:
+    std::map<std::size_t, std::size_t> m_free; // offset -> size
+    std::size_t m_capacity = 0;
+    std::size_t m_freeSize = 0;
+};
+
+// 0 = invalid
+using GeometryHandle = std::uint32_t;
+
+// Where a mesh lives inside its layout's pool
+struct GeometryRange
+{
+    VertexLayout layout;
+    GLint baseVertex = 0;         // added to every index (glDrawElementsBaseVertex)
+    std::uint32_t vertexCount = 0;
+    std::size_t indexOffset = 0;  // bytes into the pool's index buffer
+    std::size_t indexBytes = 0;   // reserved, rounded up to 4
+};
+
+struct GeometryStats
+{
+    std::uint32_t pools = 0;       // one per VertexLayout in use
+    std::uint32_t meshes = 0;
+    std::size_t capacityBytes = 0; // all pool buffers
+    std::size_t usedBytes = 0;
+    std::uint32_t repacks = 0;     // grows + defragmentations since startup
+};
+
+// Shared geometry: per VertexLayout a pool of three immutable buffers (positions,
+// normal/uv, indices of both widths) and one VAO over them. Meshes are sub-ranges
+// drawn with base-vertex draws, so drawing mesh after mesh never switches VAOs.
+// A pool that runs out of room (or only has fragmented room) is repacked: new
+// buffers, live ranges copied over on the GPU back to back, VAO re-pointed.
+// Offsets move when that happens, so look ranges up by handle at draw time.
+// Uploads, copies and VAO edits are DSA calls: none of them disturb bound state.
+// Dynamic meshes rewrite their vertices in place through a StreamBuffer staging ring.
+class GeometryArena
+{
+public:
+    static GeometryArena& Get();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Copies the mesh's streams and indices (all LODs) into its layout's pool
+    GeometryHandle Allocate(const PackedMeshView& mesh);
+    // Unknown handles (e.g. after Shutdown) are ignored
+    void Free(GeometryHandle handle);
+    const GeometryRange& Range(GeometryHandle handle) const { return m_ranges[handle]; }
+
+    // Dynamic geometry: fill(positions, attributes) writes the handle's vertexCount vertices
+    // straight into the streaming ring, which are then copied over the range on the GPU
+    // (glCopyNamedBufferSubData: no CPU wait on draws still reading the old vertices)
+    bool UpdateVertices(GeometryHandle handle, const std::function<void(void* positions, void* attributes)>& fill);
+
+    // Binds the layout's VAO (GLState skips it if it is still bound)
+    void Bind(const VertexLayout& layout);
+    // Same, with the per-instance attributes (see InstanceData) reading from instances;
+    // only the VAO's instance binding changes, and only when the buffer does
+    void Bind(const VertexLayout& layout, const Buffer& instances);
+
+    // Compacts every pool in place of its current capacity
+    void Defragment();
+
+    GeometryStats Stats() const;
+
+    // Releases the pools (needs the GL context still current)
+    void Shutdown();
+
+private:
+    GeometryArena() = default;
+
+    struct Pool
+    {
+        VertexLayout layout;
+        // empty until the first Repack creates them
+        Buffer positions;
+        Buffer attributes;
+        Buffer indices;
+        VertexArray vao;
+        RangeAllocator vertices; // in vertices: same offset in both streams
+        RangeAllocator indexBytes;
+        std::uint64_t instanceBuffer = 0; // Buffer::Serial() bound to INSTANCE_BINDING
+    };
+
+    // VAO vertex buffer binding points
+    enum : GLuint { POSITION_BINDING = 0, ATTRIBUTE_BINDING = 1, INSTANCE_BINDING = 2 };
+
+    static constexpr std::size_t INITIAL_VERTICES = std::size_t(1) << 16;
+    static constexpr std::size_t INITIAL_INDEX_BYTES = std::size_t(1) << 20;
+
+    Pool& PoolFor(const VertexLayout& layout);
+    // New buffers of the given capacity with every live range of the pool copied to the front
+    void Repack(Pool& pool, std::size_t vertexCapacity, std::size_t indexCapacity);
+    // Re-points the vertex/index bindings at the pool's current buffers
+    void PointVertexStreams(Pool& pool);
+    // Once per pool: every attribute's format and binding point, including the instance ones
+    void SetAttributeFormats(Pool& pool);
+
+    std::vector<std::unique_ptr<Pool>> m_pools;
+    std::vector<GeometryRange> m_ranges{ 1 }; // [0] = invalid
+    std::vector<std::uint8_t> m_live{ 0 };
+    std::vector<GeometryHandle> m_freeHandles;
+    std::uint32_t m_repacks = 0;
+    std::unique_ptr<StreamBuffer> m_staging; // created by the first UpdateVertices
+};
@@ -0,0 +1,248 @@
+#include "GpuScene.h"
+#include "GeometryArena.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+// cull.comp
+static const GLuint CULL_GROUP_SIZE = 64;
+static const GLint OBJECT_COUNT_LOC = 0;
+static const GLint CAMERA_PLANES_LOC = 1;  // 6 locations
+static const GLint CAMERA_LOD_LOC = 7;
+static const GLint SHADOW_LOD_LOC = 8;
+static const GLint FACE_PLANES_LOC = 9;    // 36 locations, 6 planes per face
+enum : GLuint { OBJECT_BINDING = 0, COMMAND_BINDING = 1, INSTANCE_BINDING = 2, STATS_BINDING = 3 };
+
+// xyz = eye, w = pixels per unit of error at distance 1 over the allowed error (0 = LOD 0 only)
+static void SetLodUniform(GLint location, const LodSelector& lod)
+{
+    float scale = lod.maxPixelError > 0.0f ? lod.projScale / lod.maxPixelError : 0.0f;
+    glUniform4f(location, lod.eye.x, lod.eye.y, lod.eye.z, scale);
+}
+
+GpuScene::GpuScene(const std::string& shaderDir)
+    : m_cull(shaderDir + "/cull.comp")
+{
+    m_statsBuffer.SetStorage(nullptr, sizeof(GpuCullStats), GL_DYNAMIC_STORAGE_BIT);
+}
+
+void GpuScene::BeginReloadShaders(const std::string& changedPath)
+{
+    if (changedPath.empty() || m_cull.UsesFile(changedPath))
+        m_cull.BeginReload();
+}
+
+void GpuScene::PollShaders()
+{
+    m_cull.PollReload();
+}
+
+void GpuScene::Build(const std::vector<GpuSceneItem>& items)
+{
+    PROFILE_SCOPE("GpuScene::Build");
+
+    // one group per (layout, index type): the unit of a multi-draw
+    m_groups.clear();
+    std::vector<std::uint32_t> groupOf(items.size());
+    for (std::size_t i = 0; i < items.size(); i++)
+    {
+        const Mesh& mesh = *items[i].mesh;
+        auto it = std::find_if(m_groups.begin(), m_groups.end(),
+            [&](const Group& g) { return g.layout == mesh.Layout() && g.indexType == mesh.IndexType(); });
+        if (it == m_groups.end())
+        {
+            m_groups.push_back({ mesh.Layout(), mesh.IndexType() });
+            it = m_groups.end() - 1;
+        }
+        groupOf[i] = static_cast<std::uint32_t>(it - m_groups.begin());
+        it->objectCount++;
+    }
+    for (std::size_t g = 1; g < m_groups.size(); g++)
+        m_groups[g].firstObject = m_groups[g - 1].firstObject + m_groups[g - 1].objectCount;
+
+    // objects of a group are contiguous, in submission order
+    std::vector<std::uint32_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+        [&](std::uint32_t a, std::uint32_t b) { return groupOf[a] < groupOf[b]; });
+
+    m_meshes.resize(items.size());
+    m_objects.assign(items.size(), GpuObject{});
+    m_instances.assign(items.size(), InstanceData{});
+    m_objectOf.resize(items.size());
+    for (std::uint32_t object = 0; object < order.size(); object++)
+    {
+        const GpuSceneItem& item = items[order[object]];
+        m_objectOf[order[object]] = object;
+        m_meshes[object] = item.mesh;
+        WriteObject(object, item.world, item.normalMatrix);
+        WriteGeometry(object);
+    }
+
+    // immutable, sized by the object count: a new Build replaces the buffers
+    // (empty storage is invalid; Cull and Draw skip an empty scene anyway)
+    if (!m_objects.empty())
+    {
+        m_objectBuffer.SetStorage(m_objects.data(), m_objects.size() * sizeof(GpuObject), GL_DYNAMIC_STORAGE_BIT);
+        m_instanceBuffer.SetStorage(m_instances.data(), m_instances.size() * sizeof(InstanceData), GL_DYNAMIC_STORAGE_BIT);
+        // written by the cull shader only
+        m_commandBuffer.SetStorage(nullptr, 2 * m_objects.size() * sizeof(DrawElementsIndirectCommand), 0);
+    }
+
+    m_dirtyBegin = m_dirtyEnd = 0;
+    m_geometryRepacks = GeometryArena::Get().Stats().repacks;
+}
+
+void GpuScene::UpdateObject(std::uint32_t item, const glm::mat4& world, const glm::mat3& normalMatrix)
+{
+    WriteObject(m_objectOf[item], world, normalMatrix);
+}
+
+void GpuScene::WriteObject(std::uint32_t object, const glm::mat4& world, const glm::mat3& normalMatrix)
+{
+    const Mesh& mesh = *m_meshes[object];
+
+    // as InstanceBatcher::Add: quantized positions -> object space first
+    InstanceData& instance = m_instances[object];
+    instance.model = world * mesh.Dequantize();
+    for (int c = 0; c < 3; c++)
+        instance.normal[c] = glm::vec4(normalMatrix[c], 0.0f);
+
+    // scale as LodSelector::Select measures it
+    AABB bounds = mesh.Bounds().Transformed(world);
+    float scale = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+    GpuObject& o = m_objects[object];
+    o.boundsMin = glm::vec4(bounds.min, scale);
+    o.boundsMax = glm::vec4(bounds.max, 0.0f);
+
+    if (m_dirtyBegin == m_dirtyEnd)
+    {
+        m_dirtyBegin = object;
+        m_dirtyEnd = object + 1;
+    }
+    else
+    {
+        m_dirtyBegin = std::min(m_dirtyBegin, object);
+        m_dirtyEnd = std::max(m_dirtyEnd, object + 1);
+    }
+}
+
+void GpuScene::WriteGeometry(std::uint32_t object)
+{
+    const Mesh& mesh = *m_meshes[object];
+    const GeometryRange& geometry = GeometryArena::Get().Range(mesh.Geometry());
+    const std::size_t indexSize = mesh.IndexType() == GL_UNSIGNED_SHORT ? 2 : 4;
+    const GLuint first = static_cast<GLuint>(geometry.indexOffset / indexSize);
+
+    // unused slots repeat the coarsest level
+    GpuObject& o = m_objects[object];
+    for (int lod = 0; lod < MAX_MESH_LODS; lod++)
+    {
+        const MeshLodRange& range = mesh.Lod(std::min(lod, mesh.LodCount() - 1));
+        o.firstIndex[lod] = first + range.firstIndex;
+        o.indexCount[lod] = range.indexCount;
+        o.lodError[lod] = range.error;
+    }
+    o.info.x = static_cast<GLuint>(geometry.baseVertex);
+    o.info.y = static_cast<GLuint>(mesh.LodCount());
+}
+
+void GpuScene::Cull(const GpuCullParams& params)
+{
+    PROFILE_SCOPE("GpuCull");
+
+    const std::uint32_t count = ObjectCount();
+    if (count == 0 || !IsValid())
+        return;
+
+    // a repack moved the index ranges: every object's geometry is stale
+    std::uint32_t repacks = GeometryArena::Get().Stats().repacks;
+    if (repacks != m_geometryRepacks)
+    {
+        for (std::uint32_t object = 0; object < count; object++)
+            WriteGeometry(object);
+        m_dirtyBegin = 0;
+        m_dirtyEnd = count;
+        m_geometryRepacks = repacks;
+    }
+
+    if (m_dirtyBegin < m_dirtyEnd)
+    {
+        const std::size_t n = m_dirtyEnd - m_dirtyBegin;
+        m_objectBuffer.SetSubData(m_dirtyBegin * sizeof(GpuObject), &m_objects[m_dirtyBegin], n * sizeof(GpuObject));
+        m_instanceBuffer.SetSubData(m_dirtyBegin * sizeof(InstanceData), &m_instances[m_dirtyBegin], n * sizeof(InstanceData));
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+
+    const GpuCullStats zero;
+    m_statsBuffer.SetSubData(0, &zero, sizeof(zero));
+
+    glm::vec4 facePlanes[36];
+    for (int face = 0; face < 6; face++)
+        std::copy(params.shadowFaces[face].planes, params.shadowFaces[face].planes + 6, facePlanes + face * 6);
+
+    m_cull.Use();
+    glUniform1ui(OBJECT_COUNT_LOC, count);
+    glUniform4fv(CAMERA_PLANES_LOC, 6, &params.camera.planes[0].x);
+    SetLodUniform(CAMERA_LOD_LOC, params.cameraLod);
+    SetLodUniform(SHADOW_LOD_LOC, params.shadowLod);
+    glUniform4fv(FACE_PLANES_LOC, 36, &facePlanes[0].x);
+
+    GLState& state = GLState::Get();
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer.Id());
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer.Id());
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceBuffer.Id());
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, STATS_BINDING, m_statsBuffer.Id());
+
+    glDispatchCompute((count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // commands and face masks are read by the draws, instances/stats rewritten by SetSubData next frame
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GpuScene::Draw(std::uint32_t firstCommand) const
+{
+    if (m_objects.empty())
+        return;
+
+    GeometryArena& arena = GeometryArena::Get();
+    RenderStats& stats = GetRenderStats();
+    m_commandBuffer.Bind();
+
+    for (const Group& group : m_groups)
+    {
+        arena.Bind(group.layout, m_instanceBuffer);
+        const std::uintptr_t offset = (firstCommand + group.firstObject) * sizeof(DrawElementsIndirectCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, group.indexType, reinterpret_cast<const void*>(offset),
+            static_cast<GLsizei>(group.objectCount), 0);
+
+        stats.drawCalls++;
+        stats.indirectCommands += group.objectCount;
+    }
+}
+
+void GpuScene::DrawLit() const
+{
+    PROFILE_SCOPE("GpuDrawLit");
+    Draw(0);
+}
+
+void GpuScene::DrawShadow() const
+{
+    PROFILE_SCOPE("GpuDrawShadow");
+    Draw(ObjectCount());
+}
+
+GpuCullStats GpuScene::ReadStats() const
+{
+    GpuCullStats stats;
+    if (m_objects.empty() || !IsValid())
+        return stats;
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    m_statsBuffer.GetSubData(0, &stats, sizeof(stats));
+    return stats;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Bounds.h"
+#include "Buffer.h"
+#include "InstanceBatcher.h"
+#include "Mesh.h"
+#include "ShaderProgram.h"
+
+// std430 mirror of Object in cull.comp (vec4-sized members only, like the UBO blocks)
+struct GpuObject
+{
+    glm::vec4 boundsMin{ 0.0f };   // world AABB; w = largest axis scale of the world matrix
+    glm::vec4 boundsMax{ 0.0f };   // w unused
+    glm::uvec4 firstIndex;         // per LOD, in indices from the start of the pool's index buffer
+    glm::uvec4 indexCount;         // per LOD
+    glm::vec4 lodError{ 0.0f };    // per LOD, object space (see MeshLodRange)
+    glm::uvec4 info;               // x = base vertex, y = LOD count
+};
+static_assert(sizeof(GpuObject) == 96, "GpuObject must match the std430 layout");
+static_assert(MAX_MESH_LODS == 4, "GpuObject stores the LODs in uvec4/vec4");
+
+// glMultiDrawElementsIndirect record (tightly packed, stride 0)
+struct DrawElementsIndirectCommand
+{
+    GLuint count = 0;
+    GLuint instanceCount = 0;
+    GLuint firstIndex = 0;
+    GLint baseVertex = 0;
+    GLuint baseInstance = 0;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must be tightly packed");
+
+// One scene object as handed to GpuScene::Build
+struct GpuSceneItem
+{
+    const Mesh* mesh = nullptr;
+    glm::mat4 world{ 1.0f };
+    glm::mat3 normalMatrix{ 1.0f };
+};
+
+// Per-frame inputs of GpuScene::Cull
+struct GpuCullParams
+{
+    Frustum camera;
+    LodSelector cameraLod;
+    Frustum shadowFaces[6]; // PointShadowMap::FaceFrustum
+    LodSelector shadowLod;
+};
+
+// Totals written by the cull shader (atomics), for the end-of-run summary
+struct GpuCullStats
+{
+    std::uint32_t cameraVisible = 0;
+    std::uint32_t cameraLodReduced = 0;
+    std::uint32_t shadowCasters = 0;    // objects in at least one cube face
+    std::uint32_t shadowFaces = 0;      // (caster, face) pairs
+    std::uint32_t shadowLodReduced = 0;
+    std::uint32_t triangles = 0;        // lit pass
+};
+
+// GPU-driven path: the object list (instance data + bounds + LOD ranges) lives on the
+// GPU, uploaded once by Build and patched only for objects that move. Each frame one
+// compute dispatch (cull.comp) frustum culls every object against the camera and the
+// 6 shadow cube faces, picks LODs by screen-space error and writes one indirect command
+// per object and pass (instanceCount 0 = culled) plus the object's cube face mask.
+// Each pass is then one glMultiDrawElementsIndirect per (vertex layout, index type),
+// however many objects there are.
+class GpuScene
+{
+public:
+    // shaderDir holds cull.comp
+    explicit GpuScene(const std::string& shaderDir);
+
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    bool IsValid() const { return m_cull.Id() != 0; }
+
+    void BeginReloadShaders(const std::string& changedPath = {});
+    void PollShaders();
+
+    // Replaces the object list; item i can then be moved with UpdateObject(i, ...).
+    // The meshes must outlive the scene (or the next Build).
+    void Build(const std::vector<GpuSceneItem>& items);
+    // Uploaded with the next Cull (one range covering every moved object)
+    void UpdateObject(std::uint32_t item, const glm::mat4& world, const glm::mat3& normalMatrix);
+    std::uint32_t ObjectCount() const { return static_cast<std::uint32_t>(m_objects.size()); }
+
+    // Dispatches the cull shader; the draws below wait for it (command barrier)
+    void Cull(const GpuCullParams& params);
+
+    // Lit pass: program, UBOs and textures already bound
+    void DrawLit() const;
+    // Shadow pass: the instances carry their face masks, as the geometry-shader path
+    // (shadow_cube_layered.vert) reads them
+    void DrawShadow() const;
+
+    // Reads the counters of the last Cull back (stalls: end of run only)
+    GpuCullStats ReadStats() const;
+
+private:
+    struct Group
+    {
+        VertexLayout layout;
+        GLenum indexType = GL_UNSIGNED_INT;
+        std::uint32_t firstObject = 0;
+        std::uint32_t objectCount = 0;
+    };
+
+    void WriteObject(std::uint32_t object, const glm::mat4& world, const glm::mat3& normalMatrix);
+    // Index ranges move when the GeometryArena repacks
+    void WriteGeometry(std::uint32_t object);
+    void Draw(std::uint32_t firstCommand) const;
+
+    ShaderProgram m_cull;
+
+    std::vector<const Mesh*> m_meshes;        // per object
+    std::vector<GpuObject> m_objects;
+    std::vector<InstanceData> m_instances;
+    std::vector<std::uint32_t> m_objectOf;    // item -> object (objects are sorted by group)
+    std::vector<Group> m_groups;
+
+    Buffer m_objectBuffer{ GL_SHADER_STORAGE_BUFFER };
+    Buffer m_instanceBuffer{ GL_ARRAY_BUFFER };
+    Buffer m_commandBuffer{ GL_DRAW_INDIRECT_BUFFER }; // lit [0, N), shadow [N, 2N)
+    Buffer m_statsBuffer{ GL_SHADER_STORAGE_BUFFER };
+
+    std::uint32_t m_dirtyBegin = 0;          // objects [begin, end) to upload
+    std::uint32_t m_dirtyEnd = 0;
+    std::uint32_t m_geometryRepacks = 0;     // GeometryStats::repacks the ranges were read at
+};
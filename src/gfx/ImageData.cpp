@@ -0,0 +1,83 @@
+#include "ImageData.h"
+#include "CookedTexture.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+int ImageData::RowCount(int level) const
+{
+    return IsCompressed() ? (levels[level].height + 3) / 4 : height;
+}
+
+std::size_t ImageData::RowBytes(int level) const
+{
+    if (IsCompressed())
+        return static_cast<std::size_t>((levels[level].width + 3) / 4) * CompressedBlockBytes(format);
+    return static_cast<std::size_t>(width) * channels;
+}
+
+const unsigned char* ImageData::LevelData(int level) const
+{
+    return pixels.data() + (IsCompressed() ? levels[level].offset : 0);
+}
+
+ImageData ImageData::HalfSize() const
+{
+    ImageData dst;
+    dst.width = std::max(1, width / 2);
+    dst.height = std::max(1, height / 2);
+    dst.channels = channels;
+    dst.pixels.resize(static_cast<std::size_t>(dst.width) * dst.height * channels);
+
+    for (int y = 0; y < dst.height; y++)
+    {
+        std::size_t y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < dst.width; x++)
+        {
+            std::size_t x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < channels; c++)
+            {
+                int sum = pixels[(y0 * width + x0) * channels + c] + pixels[(y0 * width + x1) * channels + c]
+                    + pixels[(y1 * width + x0) * channels + c] + pixels[(y1 * width + x1) * channels + c];
+                dst.pixels[(static_cast<std::size_t>(y) * dst.width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+bool DecodeImage(const std::string& path, ImageData& out)
+{
+    if (std::filesystem::path(path).extension() == COOKED_TEXTURE_EXT)
+        return ReadCookedTexture(path, out);
+
+    // Most images have (0,0) at top-left; OpenGL UV origin is bottom-left.
+    // Flipping is usually what you want for typical PNGs.
+    // (per-thread flag: decodes may run on a worker)
+    stbi_set_flip_vertically_on_load_thread(1);
+
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 0);
+    if (!data)
+    {
+        std::cerr << "Failed to load texture: " << path << "\n";
+        return false;
+    }
+
+    if (channels != 3 && channels != 4)
+    {
+        std::cerr << "Unsupported texture channel count (" << channels
+            << ") for: " << path << "\n";
+        stbi_image_free(data);
+        return false;
+    }
+
+    out.width = w;
+    out.height = h;
+    out.channels = channels;
+    out.pixels.assign(data, data + static_cast<std::size_t>(w) * h * channels);
+
+    stbi_image_free(data);
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// CPU-side images, no GL calls (glad only for GLenum and the format constants): shared by
+// Texture2D / TextureManager and the offline TexCook tool.
+
+// One mip level of a block-compressed image, a byte range inside ImageData::pixels
+struct ImageLevel
+{
+    int width = 0;
+    int height = 0;
+    std::size_t offset = 0;
+    std::size_t size = 0;
+};
+
+// Decoded 8-bit pixels, bottom row first (GL convention), or a cooked BCn image
+// with its whole mip chain
+struct ImageData
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0; // 3 or 4
+    GLenum format = 0; // compressed internal format, 0 = raw pixels
+    std::vector<unsigned char> pixels;
+    std::vector<ImageLevel> levels; // compressed only, level 0 first
+
+    bool IsCompressed() const { return format != 0; }
+    int LevelCount() const { return IsCompressed() ? static_cast<int>(levels.size()) : 1; }
+
+    // Uploads go by rows: pixel rows when raw, rows of 4x4 blocks when compressed
+    int RowCount(int level) const;
+    std::size_t RowBytes(int level) const;
+    const unsigned char* LevelData(int level) const;
+
+    // Raw images only: 2x2 box filter (odd edges repeat), at least 1x1
+    ImageData HalfSize() const;
+};
+
+// Decodes an image file (stb_image: PNG/JPG/TGA/...) or reads a cooked .ctex, whose BCn
+// blocks and mips come back as stored. Safe on any thread.
+bool DecodeImage(const std::string& path, ImageData& out);
@@ -0,0 +1,131 @@
+#include "InstanceBatcher.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+InstanceBatcher::InstanceBatcher()
+    : m_stream(GL_ARRAY_BUFFER, 64 * sizeof(InstanceData))
+{
+}
+
+void InstanceBatcher::Clear()
+{
+    m_pending.clear();
+    m_instances.clear();
+    m_batches.clear();
+}
+
+void InstanceBatcher::Add(const Mesh* mesh, const glm::mat4& model, const glm::mat3& normalMatrix, bool uniformScale,
+    GLuint layerMask, int lod)
+{
+    Pending p{ mesh, uniformScale, -1, lod, InstanceData{} };
+    // quantized positions -> object space first; uniform scale, so the normal matrix is unaffected
+    p.data.model = model * mesh->Dequantize();
+    p.data.layerMask = layerMask;
+    for (int c = 0; c < 3; c++)
+        p.data.normal[c] = glm::vec4(normalMatrix[c], 0.0f);
+
+    m_pending.push_back(p);
+}
+
+void InstanceBatcher::Add(const Mesh* mesh, const glm::mat4& model)
+{
+    glm::mat3 m(model);
+    float sx = glm::length(m[0]), sy = glm::length(m[1]), sz = glm::length(m[2]);
+    float eps = 1e-5f * std::max({ sx, sy, sz });
+    bool uniform = std::abs(sx - sy) <= eps && std::abs(sx - sz) <= eps;
+
+    Add(mesh, model, glm::transpose(glm::inverse(m)), uniform);
+}
+
+void InstanceBatcher::Build(bool splitLayers)
+{
+    if (splitLayers)
+    {
+        std::vector<Pending> split;
+        split.reserve(m_pending.size());
+        for (const Pending& p : m_pending)
+        {
+            for (GLuint mask = p.data.layerMask; mask != 0; mask &= mask - 1)
+            {
+                Pending one = p;
+                one.layer = std::countr_zero(mask);
+                one.data.layerMask = 1u << one.layer;
+                split.push_back(one);
+            }
+        }
+        m_pending.swap(split);
+    }
+
+    // stable: keeps submission order within a group
+    std::stable_sort(m_pending.begin(), m_pending.end(),
+        [](const Pending& a, const Pending& b)
+        {
+            if (a.layer != b.layer) return a.layer < b.layer;
+            if (a.uniformScale != b.uniformScale) return a.uniformScale;
+            if (a.mesh != b.mesh) return a.mesh < b.mesh;
+            return a.lod < b.lod;
+        });
+
+    m_instances.clear();
+    m_batches.clear();
+    m_instances.reserve(m_pending.size());
+
+    for (const Pending& p : m_pending)
+    {
+        if (m_batches.empty() || m_batches.back().mesh != p.mesh || m_batches.back().uniformScale != p.uniformScale ||
+            m_batches.back().layer != p.layer || m_batches.back().lod != p.lod)
+            m_batches.push_back({ p.mesh, static_cast<GLuint>(m_instances.size()), 0, p.uniformScale, p.layer, p.lod });
+
+        m_batches.back().instanceCount++;
+        m_instances.push_back(p.data);
+    }
+    m_pending.clear();
+
+    // straight into this frame's region of the ring; the draws add its position to
+    // baseInstance, so the VAO's instance binding never moves
+    m_baseInstance = 0;
+    if (!m_instances.empty())
+    {
+        const std::size_t bytes = m_instances.size() * sizeof(InstanceData);
+        StreamAllocation a = m_stream.Allocate(bytes, sizeof(InstanceData));
+        if (a.data == nullptr)
+        {
+            m_batches.clear();
+            return;
+        }
+        std::memcpy(a.data, m_instances.data(), bytes);
+        m_baseInstance = static_cast<GLuint>(a.offset / sizeof(InstanceData));
+    }
+}
+
+bool InstanceBatcher::Matches(const Batch& b, ScaleFilter filter)
+{
+    return filter == ScaleFilter::All || b.uniformScale == (filter == ScaleFilter::Uniform);
+}
+
+bool InstanceBatcher::HasBatches(ScaleFilter filter) const
+{
+    return std::any_of(m_batches.begin(), m_batches.end(),
+        [&](const Batch& b) { return Matches(b, filter); });
+}
+
+void InstanceBatcher::Draw(ScaleFilter filter) const
+{
+    for (const Batch& b : m_batches)
+    {
+        if (Matches(b, filter))
+            b.mesh->DrawInstanced(m_stream.GetBuffer(), b.instanceCount, m_baseInstance + b.firstInstance, b.lod);
+    }
+}
+
+void InstanceBatcher::DrawLayer(int layer) const
+{
+    for (const Batch& b : m_batches)
+    {
+        if (b.layer == layer)
+            b.mesh->DrawInstanced(m_stream.GetBuffer(), b.instanceCount, m_baseInstance + b.firstInstance, b.lod);
+    }
+}
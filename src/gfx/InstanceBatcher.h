@@ -0,0 +1,85 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "StreamBuffer.h"
+
+class Mesh;
+
+// Per-instance vertex data (attribute locations 3..10, see Mesh::DrawInstanced).
+// Normal matrix columns are padded to vec4 to keep the struct 16-byte aligned.
+struct InstanceData
+{
+    glm::mat4 model{ 1.0f };
+    glm::vec4 normal[3] = { glm::vec4(1, 0, 0, 0), glm::vec4(0, 1, 0, 0), glm::vec4(0, 0, 1, 0) };
+    GLuint layerMask = ~0u; // layered targets (cube shadow faces) this instance touches
+    GLuint pad[3] = {};     // stride stays 128 bytes
+};
+
+// Which batches to draw: uniform-scale instances can use the UNIFORM_SCALE shader
+// variant, which derives normals from mat3(model) and skips the normal matrix.
+enum class ScaleFilter
+{
+    All,
+    Uniform,
+    NonUniform
+};
+
+// Collects (mesh, model matrix) pairs, groups them by Mesh* (and LOD) and writes all instances
+// into one StreamBuffer region so every group is a single glDrawElementsInstanced call.
+// Build once per frame, then Draw() in as many passes as needed.
+class InstanceBatcher
+{
+public:
+    struct Batch
+    {
+        const Mesh* mesh = nullptr;
+        GLuint firstInstance = 0; // in this build's instances
+        GLsizei instanceCount = 0;
+        bool uniformScale = false;
+        int layer = -1; // set by Build(true)
+        int lod = 0;
+    };
+
+    InstanceBatcher();
+
+    void Clear();
+
+    // Normal matrix and scale classification precomputed by the caller (TransformStore)
+    void Add(const Mesh* mesh, const glm::mat4& model, const glm::mat3& normalMatrix, bool uniformScale,
+        GLuint layerMask = ~0u, int lod = 0);
+    // Derives both from the model matrix
+    void Add(const Mesh* mesh, const glm::mat4& model);
+
+    // Groups by (scale class, mesh, LOD) and writes the instances into the stream.
+    // splitLayers emits every instance once per bit of its layer mask (one bit each),
+    // grouped by layer first, so DrawLayer() only draws what touches that layer.
+    void Build(bool splitLayers = false);
+
+    // One instanced draw per matching batch (uses whatever program is bound).
+    void Draw(ScaleFilter filter = ScaleFilter::All) const;
+    // Only after Build(true)
+    void DrawLayer(int layer) const;
+
+    bool HasBatches(ScaleFilter filter) const;
+    const std::vector<Batch>& Batches() const { return m_batches; }
+    std::size_t InstanceCount() const { return m_instances.size(); }
+
+private:
+    struct Pending
+    {
+        const Mesh* mesh;
+        bool uniformScale;
+        int layer;
+        int lod;
+        InstanceData data;
+    };
+
+    static bool Matches(const Batch& b, ScaleFilter filter);
+
+    std::vector<Pending> m_pending;
+    std::vector<InstanceData> m_instances;
+    std::vector<Batch> m_batches;
+    StreamBuffer m_stream;
+    GLuint m_baseInstance = 0; // this frame's instances in m_stream, in InstanceData units
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory map of a whole file (mmap / MapViewOfFile). Empty files and
+// failures leave Data() null; the mapping lives as long as the object.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    bool IsOpen() const { return m_data != nullptr; }
+
+    const char* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    void Close();
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;    // HANDLE
+    void* m_mapping = nullptr; // HANDLE
+#endif
+};
@@ -1,31 +1,153 @@
 #include "Mesh.h"
+#include "RenderStats.h"
+#include "InstanceBatcher.h"
+#include "CookedMesh.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility> // std::exchange
+
+namespace
+{
+    MeshData CopyMeshData(const float* vertices, std::size_t vBytes, const unsigned int* indices, int indexCount)
+    {
+        MeshData data;
+        data.vertices.assign(vertices, vertices + vBytes / sizeof(float));
+        data.indices.assign(indices, indices + indexCount);
+        return data;
+    }
+}
 
 Mesh::Mesh(const float* vertices, std::size_t vBytes,
     const unsigned int* indices, std::size_t iBytes,
-    int indexCount)
-    : m_vbo(GL_ARRAY_BUFFER),
-    m_ebo(GL_ELEMENT_ARRAY_BUFFER),
-    m_indexCount(indexCount)
+    int indexCount, const VertexLayout& layout)
+    : Mesh(CopyMeshData(vertices, vBytes, indices, std::min<std::size_t>(indexCount, iBytes / sizeof(unsigned int))), layout)
+{
+}
+
+Mesh::Mesh(const MeshData& data, const VertexLayout& layout)
+    : Mesh(PackMesh(data, layout).View())
+{
+}
+
+Mesh::Mesh(const CookedMesh& cooked)
+    : Mesh(cooked.view)
+{
+}
+
+Mesh::Mesh(const PackedMeshView& packed)
+    : m_indexType(packed.indexType),
+    m_bounds(packed.bounds),
+    m_layout(packed.layout)
+{
+    if (packed.lodCount == 0)
+    {
+        m_lods[0] = { 0, packed.indexCount, 0.0f };
+    }
+    else
+    {
+        m_lodCount = static_cast<int>(std::min<std::uint32_t>(packed.lodCount, MAX_MESH_LODS));
+        std::copy(packed.lods, packed.lods + m_lodCount, m_lods);
+    }
+
+    m_geometry = GeometryArena::Get().Allocate(packed);
+
+    m_dequantize = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(packed.dequantize)), glm::vec3(packed.dequantize.w));
+    const GeometryRange& geometry = GeometryArena::Get().Range(m_geometry);
+    m_gpuBytes = geometry.vertexCount * m_layout.VertexBytes() + geometry.indexBytes;
+}
+
+Mesh::~Mesh()
+{
+    GeometryArena::Get().Free(m_geometry);
+}
+
+Mesh::Mesh(Mesh&& other) noexcept
+    : m_geometry(std::exchange(other.m_geometry, 0)),
+    m_lodCount(other.m_lodCount),
+    m_indexType(other.m_indexType),
+    m_bounds(other.m_bounds),
+    m_layout(other.m_layout),
+    m_dequantize(other.m_dequantize),
+    m_gpuBytes(other.m_gpuBytes)
+{
+    std::copy(other.m_lods, other.m_lods + MAX_MESH_LODS, m_lods);
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept
+{
+    if (this == &other) return *this;
+    GeometryArena::Get().Free(m_geometry);
+    m_geometry = std::exchange(other.m_geometry, 0);
+    std::copy(other.m_lods, other.m_lods + MAX_MESH_LODS, m_lods);
+    m_lodCount = other.m_lodCount;
+    m_indexType = other.m_indexType;
+    m_bounds = other.m_bounds;
+    m_layout = other.m_layout;
+    m_dequantize = other.m_dequantize;
+    m_gpuBytes = other.m_gpuBytes;
+    return *this;
+}
+
+bool Mesh::UpdateVertices(const float* vertices, std::size_t vertexCount)
+{
+    GeometryArena& arena = GeometryArena::Get();
+    if (m_geometry == 0 || vertexCount != arena.Range(m_geometry).vertexCount)
+        return false;
+
+    AABB bounds;
+    glm::vec4 dequantize(0.0f);
+    bool updated = arena.UpdateVertices(m_geometry, [&](void* positions, void* attributes)
+        {
+            dequantize = PackVertices(vertices, vertexCount, m_layout, positions, attributes, bounds);
+        });
+    if (!updated)
+        return false;
+
+    m_bounds = bounds;
+    m_dequantize = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(dequantize)), glm::vec3(dequantize.w));
+    return true;
+}
+
+void Mesh::DrawInstanced(const Buffer& instances, GLsizei instanceCount, GLuint baseInstance, int lod) const
 {
-    m_vao.Bind();
+    if (instanceCount <= 0)
+        return;
 
-    m_vbo.Bind();
-    m_vbo.SetData(vertices, vBytes, GL_STATIC_DRAW);
+    GeometryArena& arena = GeometryArena::Get();
+    const GeometryRange& geometry = arena.Range(m_geometry);
+    arena.Bind(m_layout, instances);
 
-    m_ebo.Bind();
-    m_ebo.SetData(indices, iBytes, GL_STATIC_DRAW);
+    const MeshLodRange& range = m_lods[lod];
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), m_indexType,
+        IndexOffset(geometry, range), instanceCount, geometry.baseVertex, baseInstance);
 
-    // Layout: pos(3), normal(3), uv(2) = 8 floats
-    m_vao.SetAttribute(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
-    m_vao.SetAttribute(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 3 * sizeof(float));
-    m_vao.SetAttribute(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 6 * sizeof(float));
+    RenderStats& stats = GetRenderStats();
+    stats.drawCalls++;
+    stats.triangles += static_cast<std::uint64_t>(range.indexCount / 3) * instanceCount;
+}
 
-    VertexArray::Unbind();
-    Buffer::Unbind(GL_ARRAY_BUFFER);
+const void* Mesh::IndexOffset(const GeometryRange& geometry, const MeshLodRange& range) const
+{
+    const std::size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(geometry.indexOffset + range.firstIndex * indexSize));
 }
 
-void Mesh::Draw() const
+int LodSelector::Select(const Mesh& mesh, const glm::mat4& model, const AABB& worldBounds) const
 {
-    m_vao.Bind();
-    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, (void*)0);
+    if (mesh.LodCount() == 1 || maxPixelError <= 0.0f)
+        return 0;
+
+    glm::vec3 nearest = glm::clamp(eye, worldBounds.min, worldBounds.max);
+    float distance = glm::length(nearest - eye);
+    if (distance <= 0.0f)
+        return 0;
+
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+    float pixelsPerUnit = projScale * scale / distance;
+
+    int lod = 0;
+    while (lod + 1 < mesh.LodCount() && mesh.Lod(lod + 1).error * pixelsPerUnit <= maxPixelError)
+        lod++;
+    return lod;
 }
@@ -1,22 +1,103 @@
 #pragma once
 #include <cstddef>
+#include <vector>
 #include <glad/glad.h>
-#include "VertexArray.h"
 #include "Buffer.h"
+#include "GeometryArena.h"
+#include "Bounds.h"
+#include "VertexLayout.h"
 
+// A coarser level of a MeshData: its own triangles over the same vertices
+struct MeshLodData
+{
+    std::vector<unsigned int> indices;
+    float error = 0.0f; // see MeshLodRange
+};
+
+// CPU-side geometry in the Mesh layout: pos(3), normal(3), uv(2) = 8 floats per vertex
+struct MeshData
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices; // LOD 0
+    std::vector<MeshLodData> lods;     // LOD 1.., filled by GenerateLods (MeshSimplifier.h)
+
+    std::size_t VertexCount() const { return vertices.size() / 8; }
+    std::size_t TriangleCount() const { return indices.size() / 3; }
+};
+
+struct CookedMesh;
+
+// GPU mesh in a VertexLayout (see VertexLayout.h); float input is packed on upload.
+// The data lives in a sub-range of the shared GeometryArena pool for its layout, so
+// meshes of one layout draw through one VAO (base-vertex draws).
+// Positions may be quantized: Dequantize() maps them back to object space and is
+// folded into the instance matrices by InstanceBatcher.
 class Mesh
 {
 public:
     Mesh(const float* vertices, std::size_t vBytes,
         const unsigned int* indices, std::size_t iBytes,
-        int indexCount);
+        int indexCount, const VertexLayout& layout = {});
+    explicit Mesh(const MeshData& data, const VertexLayout& layout = {});
+    explicit Mesh(const PackedMeshView& packed);
+    // Uploads straight from a mapped .cmesh (see CookedMesh.h), bounds from its header
+    explicit Mesh(const CookedMesh& cooked);
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
 
-    void Draw() const;
-    int IndexCount() const { return m_indexCount; }
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
+    // Dynamic geometry (procedural, deforming): replaces every vertex, in the MeshData
+    // float layout and the same count as at construction. Packed straight into the
+    // GeometryArena's streaming ring, no reallocation; indices and LODs stay. Bounds and
+    // Dequantize() follow the new positions (a GpuScene needs UpdateObject afterwards).
+    bool UpdateVertices(const float* vertices, std::size_t vertexCount);
+
+    // Draws instanceCount instances whose InstanceData (see InstanceBatcher.h) starts
+    // at baseInstance in the given buffer. The shared VAO is re-pointed only when the buffer changes.
+    void DrawInstanced(const Buffer& instances, GLsizei instanceCount, GLuint baseInstance = 0, int lod = 0) const;
+
+    // LOD 0
+    int IndexCount() const { return static_cast<int>(m_lods[0].indexCount); }
+    int LodCount() const { return m_lodCount; }
+    const MeshLodRange& Lod(int lod) const { return m_lods[lod]; }
+    GLenum IndexType() const { return m_indexType; }
+    // Local-space bounds of the vertex positions, computed at construction
+    const AABB& Bounds() const { return m_bounds; }
+
+    const VertexLayout& Layout() const { return m_layout; }
+    // Stored position -> object space (translate * uniform scale)
+    const glm::mat4& Dequantize() const { return m_dequantize; }
+    // Vertex + index bytes of its arena range
+    std::size_t GpuBytes() const { return m_gpuBytes; }
+    GeometryHandle Geometry() const { return m_geometry; }
 
 private:
-    VertexArray m_vao;
-    Buffer m_vbo;
-    Buffer m_ebo;
-    int m_indexCount = 0;
+    // Byte offset of a level's first index in the arena's index buffer, as the draw calls take it
+    const void* IndexOffset(const GeometryRange& geometry, const MeshLodRange& range) const;
+
+    GeometryHandle m_geometry = 0;
+    MeshLodRange m_lods[MAX_MESH_LODS];
+    int m_lodCount = 1;
+    GLenum m_indexType = GL_UNSIGNED_INT;
+    AABB m_bounds;
+    VertexLayout m_layout;
+    glm::mat4 m_dequantize{ 1.0f };
+    std::size_t m_gpuBytes = 0;
+};
+
+// Screen-space error LOD choice for one viewpoint: the coarsest level whose error,
+// projected at the item's distance, stays within maxPixelError
+struct LodSelector
+{
+    glm::vec3 eye{ 0.0f };
+    float projScale = 0.0f;     // pixels per world unit at distance 1: viewport height / (2 tan(fovY / 2))
+    float maxPixelError = 1.0f; // <= 0 always picks LOD 0
+
+    // model: the item's world matrix (its largest axis scale sizes the error);
+    // worldBounds: its world AABB (distance is measured to the nearest point of it)
+    int Select(const Mesh& mesh, const glm::mat4& model, const AABB& worldBounds) const;
 };
@@ -0,0 +1,1038 @@
+#include "MeshImporter.h"
+#include "MappedFile.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    constexpr std::size_t FLOATS_PER_VERTEX = 8;
+
+    // ---- shared ----
+
+    // Area-weighted face normals summed into the vertices flagged in missing
+    // (indexed from firstVertex), then normalized
+    void GenerateNormals(MeshData& mesh, std::size_t firstIndex, std::size_t firstVertex, const std::vector<std::uint8_t>& missing)
+    {
+        float* v = mesh.vertices.data();
+        for (std::size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3)
+        {
+            unsigned int a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+            glm::vec3 pa(v[a * 8], v[a * 8 + 1], v[a * 8 + 2]);
+            glm::vec3 pb(v[b * 8], v[b * 8 + 1], v[b * 8 + 2]);
+            glm::vec3 pc(v[c * 8], v[c * 8 + 1], v[c * 8 + 2]);
+            glm::vec3 n = glm::cross(pb - pa, pc - pa); // length = 2 * area
+
+            for (unsigned int idx : { a, b, c })
+            {
+                if (!missing[idx - firstVertex])
+                    continue;
+                v[idx * 8 + 3] += n.x;
+                v[idx * 8 + 4] += n.y;
+                v[idx * 8 + 5] += n.z;
+            }
+        }
+
+        for (std::size_t i = firstVertex; i < mesh.VertexCount(); i++)
+        {
+            if (!missing[i - firstVertex])
+                continue;
+            glm::vec3 n(v[i * 8 + 3], v[i * 8 + 4], v[i * 8 + 5]);
+            float len = glm::length(n);
+            n = len > 0.0f ? n / len : glm::vec3(0, 1, 0);
+            v[i * 8 + 3] = n.x;
+            v[i * 8 + 4] = n.y;
+            v[i * 8 + 5] = n.z;
+        }
+    }
+
+    // ---- OBJ ----
+
+    // Corner indices as parsed: >= 0 global (0-based), -1 missing, anything below
+    // RELATIVE_MAX is a negative OBJ index stored as RELATIVE + position within the chunk
+    // (which may point into earlier chunks), fixed up after the merge
+    constexpr int MISSING = -1;
+    constexpr int RELATIVE = INT_MIN / 2;
+    constexpr int RELATIVE_MAX = -2;
+
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        std::vector<float> positions; // xyz
+        std::vector<float> uvs;       // uv
+        std::vector<float> normals;   // xyz
+        std::vector<int> corners;     // (v, vt, vn) per corner, 3 corners per triangle
+
+        std::size_t errorLine = 0;    // line within the chunk (1-based), 0 = ok
+    };
+
+    const char* SkipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+        return p;
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float& out)
+    {
+        p = SkipSpaces(p, end);
+        if (p < end && *p == '+')
+            ++p;
+        auto [next, ec] = std::from_chars(p, end, out);
+        if (ec != std::errc())
+            return false;
+        p = next;
+        return true;
+    }
+
+    bool ParseInt(const char*& p, const char* end, int& out)
+    {
+        if (p < end && *p == '+')
+            ++p;
+        auto [next, ec] = std::from_chars(p, end, out);
+        if (ec != std::errc())
+            return false;
+        p = next;
+        return true;
+    }
+
+    // OBJ index (1-based, or negative = from the end so far) -> corner encoding
+    bool ResolveIndex(int index, std::size_t countSoFar, int& out)
+    {
+        if (index > 0)
+        {
+            out = index - 1;
+            return true;
+        }
+        long long local = static_cast<long long>(countSoFar) + index;
+        if (index < 0 && local > INT_MIN / 2 && local <= RELATIVE_MAX - RELATIVE)
+        {
+            out = RELATIVE + static_cast<int>(local);
+            return true;
+        }
+        return false;
+    }
+
+    // "v", "v/vt", "v//vn" or "v/vt/vn"
+    bool ParseCorner(const char*& p, const char* end, const ObjChunk& chunk, int corner[3])
+    {
+        int v = 0;
+        if (!ParseInt(p, end, v) || !ResolveIndex(v, chunk.positions.size() / 3, corner[0]))
+            return false;
+        corner[1] = corner[2] = MISSING;
+
+        if (p < end && *p == '/')
+        {
+            ++p;
+            if (p < end && *p != '/')
+            {
+                int vt = 0;
+                if (!ParseInt(p, end, vt) || !ResolveIndex(vt, chunk.uvs.size() / 2, corner[1]))
+                    return false;
+            }
+            if (p < end && *p == '/')
+            {
+                ++p;
+                int vn = 0;
+                if (!ParseInt(p, end, vn) || !ResolveIndex(vn, chunk.normals.size() / 3, corner[2]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void ParseObjChunk(ObjChunk& chunk)
+    {
+        std::vector<int> polygon; // corners of the current face
+        std::size_t line = 0;
+
+        const char* p = chunk.begin;
+        while (p < chunk.end)
+        {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+            if (!eol)
+                eol = chunk.end;
+            line++;
+
+            p = SkipSpaces(p, eol);
+            bool ok = true;
+            if (eol - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p += 2;
+                float x, y, z;
+                ok = ParseFloat(p, eol, x) && ParseFloat(p, eol, y) && ParseFloat(p, eol, z);
+                chunk.positions.insert(chunk.positions.end(), { x, y, z }); // any w is ignored
+            }
+            else if (eol - p >= 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+            {
+                p += 3;
+                float u, v = 0.0f;
+                ok = ParseFloat(p, eol, u);
+                ParseFloat(p, eol, v); // 1D texture coordinates exist
+                chunk.uvs.insert(chunk.uvs.end(), { u, v });
+            }
+            else if (eol - p >= 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+            {
+                p += 3;
+                float x, y, z;
+                ok = ParseFloat(p, eol, x) && ParseFloat(p, eol, y) && ParseFloat(p, eol, z);
+                chunk.normals.insert(chunk.normals.end(), { x, y, z });
+            }
+            else if (eol - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p += 2;
+                polygon.clear();
+                for (;;)
+                {
+                    p = SkipSpaces(p, eol);
+                    if (p >= eol)
+                        break;
+                    int corner[3];
+                    if (!ParseCorner(p, eol, chunk, corner))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    polygon.insert(polygon.end(), corner, corner + 3);
+                }
+
+                // fan
+                std::size_t count = polygon.size() / 3;
+                ok = ok && count >= 3;
+                for (std::size_t k = 1; ok && k + 1 < count; k++)
+                {
+                    chunk.corners.insert(chunk.corners.end(), polygon.begin(), polygon.begin() + 3);
+                    chunk.corners.insert(chunk.corners.end(), polygon.begin() + k * 3, polygon.begin() + k * 3 + 6);
+                }
+            }
+            // everything else (comments, o/g/s, materials, lines, points) is ignored
+
+            if (!ok)
+            {
+                chunk.errorLine = line;
+                return;
+            }
+            p = eol + 1;
+        }
+    }
+
+    // Open addressing (linear probing) from (v, vt, vn) to the welded vertex index
+    class WeldTable
+    {
+    public:
+        explicit WeldTable(std::size_t expected)
+        {
+            std::size_t capacity = 1024;
+            while (capacity < expected * 2)
+                capacity *= 2;
+            m_slots.assign(capacity, Slot{});
+        }
+
+        // Index of the vertex for key; inserts next if it's new (and sets inserted)
+        std::uint32_t FindOrInsert(const int key[3], std::uint32_t next, bool& inserted)
+        {
+            if ((m_count + 1) * 10 > m_slots.size() * 7)
+                Grow();
+
+            std::size_t mask = m_slots.size() - 1;
+            for (std::size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+            {
+                Slot& slot = m_slots[i];
+                if (slot.index == EMPTY)
+                {
+                    std::memcpy(slot.key, key, sizeof(slot.key));
+                    slot.index = next;
+                    m_count++;
+                    inserted = true;
+                    return next;
+                }
+                if (slot.key[0] == key[0] && slot.key[1] == key[1] && slot.key[2] == key[2])
+                {
+                    inserted = false;
+                    return slot.index;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t EMPTY = 0xFFFFFFFFu;
+
+        struct Slot
+        {
+            int key[3] = {};
+            std::uint32_t index = EMPTY;
+        };
+
+        static std::size_t Hash(const int key[3])
+        {
+            std::uint64_t h = static_cast<std::uint32_t>(key[0]) * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key[1])) << 21) ^ static_cast<std::uint32_t>(key[2]);
+            h *= 0xBF58476D1CE4E5B9ull;
+            return static_cast<std::size_t>(h ^ (h >> 31));
+        }
+
+        void Grow()
+        {
+            std::vector<Slot> old(m_slots.size() * 2);
+            old.swap(m_slots);
+            std::size_t mask = m_slots.size() - 1;
+            for (const Slot& slot : old)
+            {
+                if (slot.index == EMPTY)
+                    continue;
+                std::size_t i = Hash(slot.key) & mask;
+                while (m_slots[i].index != EMPTY)
+                    i = (i + 1) & mask;
+                m_slots[i] = slot;
+            }
+        }
+
+        std::vector<Slot> m_slots;
+        std::size_t m_count = 0;
+    };
+
+    // ---- glTF ----
+
+    // Just enough JSON for a glTF header
+    struct JsonValue
+    {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> object;
+
+        const JsonValue* Find(const char* key) const
+        {
+            for (const auto& member : object)
+            {
+                if (member.first == key)
+                    return &member.second;
+            }
+            return nullptr;
+        }
+
+        const JsonValue* At(std::size_t index) const
+        {
+            return type == Type::Array && index < array.size() ? &array[index] : nullptr;
+        }
+
+        double Number(const char* key, double fallback) const
+        {
+            const JsonValue* v = Find(key);
+            return v && v->type == Type::Number ? v->number : fallback;
+        }
+
+        // Index-valued member (-1 when absent)
+        int Index(const char* key) const
+        {
+            return static_cast<int>(Number(key, -1.0));
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* begin, const char* end) : m_p(begin), m_end(end) {}
+
+        bool Parse(JsonValue& out)
+        {
+            return ParseValue(out, 0) && (SkipWhitespace(), m_p == m_end);
+        }
+
+    private:
+        static constexpr int MAX_DEPTH = 64;
+
+        void SkipWhitespace()
+        {
+            while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r'))
+                ++m_p;
+        }
+
+        bool Consume(const char* literal)
+        {
+            std::size_t len = std::strlen(literal);
+            if (static_cast<std::size_t>(m_end - m_p) < len || std::memcmp(m_p, literal, len) != 0)
+                return false;
+            m_p += len;
+            return true;
+        }
+
+        bool ParseValue(JsonValue& out, int depth)
+        {
+            if (depth > MAX_DEPTH)
+                return false;
+
+            SkipWhitespace();
+            if (m_p >= m_end)
+                return false;
+
+            switch (*m_p)
+            {
+            case '{': return ParseObject(out, depth);
+            case '[': return ParseArray(out, depth);
+            case '"': out.type = JsonValue::Type::String; return ParseString(out.string);
+            case 't': out.type = JsonValue::Type::Bool; out.boolean = true; return Consume("true");
+            case 'f': out.type = JsonValue::Type::Bool; out.boolean = false; return Consume("false");
+            case 'n': out.type = JsonValue::Type::Null; return Consume("null");
+            default:
+            {
+                out.type = JsonValue::Type::Number;
+                auto [next, ec] = std::from_chars(m_p, m_end, out.number);
+                if (ec != std::errc())
+                    return false;
+                m_p = next;
+                return true;
+            }
+            }
+        }
+
+        bool ParseObject(JsonValue& out, int depth)
+        {
+            out.type = JsonValue::Type::Object;
+            ++m_p; // {
+            SkipWhitespace();
+            if (m_p < m_end && *m_p == '}')
+            {
+                ++m_p;
+                return true;
+            }
+
+            for (;;)
+            {
+                SkipWhitespace();
+                std::pair<std::string, JsonValue> member;
+                if (m_p >= m_end || *m_p != '"' || !ParseString(member.first))
+                    return false;
+                SkipWhitespace();
+                if (m_p >= m_end || *m_p++ != ':')
+                    return false;
+                if (!ParseValue(member.second, depth + 1))
+                    return false;
+                out.object.push_back(std::move(member));
+
+                SkipWhitespace();
+                if (m_p >= m_end)
+                    return false;
+                char c = *m_p++;
+                if (c == '}')
+                    return true;
+                if (c != ',')
+                    return false;
+            }
+        }
+
+        bool ParseArray(JsonValue& out, int depth)
+        {
+            out.type = JsonValue::Type::Array;
+            ++m_p; // [
+            SkipWhitespace();
+            if (m_p < m_end && *m_p == ']')
+            {
+                ++m_p;
+                return true;
+            }
+
+            for (;;)
+            {
+                out.array.emplace_back();
+                if (!ParseValue(out.array.back(), depth + 1))
+                    return false;
+
+                SkipWhitespace();
+                if (m_p >= m_end)
+                    return false;
+                char c = *m_p++;
+                if (c == ']')
+                    return true;
+                if (c != ',')
+                    return false;
+            }
+        }
+
+        bool ParseString(std::string& out)
+        {
+            ++m_p; // "
+            while (m_p < m_end && *m_p != '"')
+            {
+                char c = *m_p++;
+                if (c != '\\')
+                {
+                    out += c;
+                    continue;
+                }
+                if (m_p >= m_end)
+                    return false;
+
+                char e = *m_p++;
+                switch (e)
+                {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    // BMP only, as UTF-8 (surrogate pairs come out as two 3-byte sequences)
+                    unsigned code = 0;
+                    auto [next, ec] = std::from_chars(m_p, std::min(m_p + 4, m_end), code, 16);
+                    if (ec != std::errc() || next != m_p + 4)
+                        return false;
+                    m_p = next;
+                    if (code < 0x80)
+                        out += static_cast<char>(code);
+                    else if (code < 0x800)
+                    {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    else
+                    {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: out += e; break; // " \ /
+                }
+            }
+            if (m_p >= m_end)
+                return false;
+            ++m_p; // "
+            return true;
+        }
+
+        const char* m_p;
+        const char* m_end;
+    };
+
+    constexpr std::uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+    constexpr std::uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+    constexpr std::uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+    enum ComponentType
+    {
+        COMPONENT_BYTE = 5120,
+        COMPONENT_UNSIGNED_BYTE = 5121,
+        COMPONENT_SHORT = 5122,
+        COMPONENT_UNSIGNED_SHORT = 5123,
+        COMPONENT_UNSIGNED_INT = 5125,
+        COMPONENT_FLOAT = 5126
+    };
+
+    // An accessor resolved to bytes inside the BIN chunk
+    struct AccessorView
+    {
+        const unsigned char* data = nullptr;
+        std::size_t count = 0;
+        std::size_t stride = 0;
+        int componentType = 0;
+        int components = 0;
+        bool normalized = false;
+
+        float Float(std::size_t i, int c) const
+        {
+            const unsigned char* p = data + i * stride;
+            switch (componentType)
+            {
+            case COMPONENT_FLOAT: { float f; std::memcpy(&f, p + c * 4, 4); return f; }
+            case COMPONENT_UNSIGNED_BYTE: return p[c] / (normalized ? 255.0f : 1.0f);
+            case COMPONENT_BYTE: { float f = static_cast<std::int8_t>(p[c]); return normalized ? std::max(f / 127.0f, -1.0f) : f; }
+            case COMPONENT_UNSIGNED_SHORT: { std::uint16_t s; std::memcpy(&s, p + c * 2, 2); return s / (normalized ? 65535.0f : 1.0f); }
+            case COMPONENT_SHORT: { std::int16_t s; std::memcpy(&s, p + c * 2, 2); return normalized ? std::max(s / 32767.0f, -1.0f) : s; }
+            default: return 0.0f;
+            }
+        }
+
+        std::uint32_t Index(std::size_t i) const
+        {
+            const unsigned char* p = data + i * stride;
+            switch (componentType)
+            {
+            case COMPONENT_UNSIGNED_BYTE: return p[0];
+            case COMPONENT_UNSIGNED_SHORT: { std::uint16_t s; std::memcpy(&s, p, 2); return s; }
+            case COMPONENT_UNSIGNED_INT: { std::uint32_t u; std::memcpy(&u, p, 4); return u; }
+            default: return 0;
+            }
+        }
+    };
+
+    int ComponentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_BYTE: case COMPONENT_UNSIGNED_BYTE: return 1;
+        case COMPONENT_SHORT: case COMPONENT_UNSIGNED_SHORT: return 2;
+        case COMPONENT_UNSIGNED_INT: case COMPONENT_FLOAT: return 4;
+        default: return 0;
+        }
+    }
+
+    int ComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    class GlbReader
+    {
+    public:
+        GlbReader(const JsonValue& root, const unsigned char* bin, std::size_t binSize, MeshData& out)
+            : m_root(root), m_bin(bin), m_binSize(binSize), m_out(out)
+        {
+        }
+
+        bool Read()
+        {
+            const JsonValue* scenes = m_root.Find("scenes");
+            const JsonValue* scene = scenes ? scenes->At(static_cast<std::size_t>(std::max(0, m_root.Index("scene")))) : nullptr;
+            const JsonValue* roots = scene ? scene->Find("nodes") : nullptr;
+
+            if (roots)
+            {
+                for (const JsonValue& node : roots->array)
+                {
+                    if (!VisitNode(static_cast<int>(node.number), glm::mat4(1.0f), 0))
+                        return false;
+                }
+                return true;
+            }
+
+            // no scene: every mesh as authored
+            const JsonValue* meshes = m_root.Find("meshes");
+            for (std::size_t i = 0; meshes && i < meshes->array.size(); i++)
+            {
+                if (!AppendMesh(meshes->array[i], glm::mat4(1.0f)))
+                    return false;
+            }
+            return true;
+        }
+
+        const std::string& Error() const { return m_error; }
+
+    private:
+        bool Fail(const std::string& error)
+        {
+            m_error = error;
+            return false;
+        }
+
+        static glm::mat4 LocalMatrix(const JsonValue& node)
+        {
+            if (const JsonValue* m = node.Find("matrix"); m && m->array.size() == 16)
+            {
+                glm::mat4 matrix(1.0f);
+                for (int c = 0; c < 4; c++)
+                    matrix[c] = glm::vec4(float(m->array[c * 4].number), float(m->array[c * 4 + 1].number),
+                        float(m->array[c * 4 + 2].number), float(m->array[c * 4 + 3].number));
+                return matrix;
+            }
+
+            glm::vec3 t(0.0f), s(1.0f);
+            float q[4] = { 0, 0, 0, 1 }; // x y z w
+            if (const JsonValue* v = node.Find("translation"); v && v->array.size() == 3)
+                t = glm::vec3(float(v->array[0].number), float(v->array[1].number), float(v->array[2].number));
+            if (const JsonValue* v = node.Find("scale"); v && v->array.size() == 3)
+                s = glm::vec3(float(v->array[0].number), float(v->array[1].number), float(v->array[2].number));
+            if (const JsonValue* v = node.Find("rotation"); v && v->array.size() == 4)
+            {
+                for (int i = 0; i < 4; i++)
+                    q[i] = float(v->array[i].number);
+            }
+
+            float x = q[0], y = q[1], z = q[2], w = q[3];
+            glm::mat4 m(1.0f);
+            m[0] = glm::vec4(1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0) * s.x;
+            m[1] = glm::vec4(2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0) * s.y;
+            m[2] = glm::vec4(2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0) * s.z;
+            m[3] = glm::vec4(t, 1.0f);
+            return m;
+        }
+
+        bool VisitNode(int index, const glm::mat4& parent, int depth)
+        {
+            const JsonValue* nodes = m_root.Find("nodes");
+            const JsonValue* node = nodes && index >= 0 ? nodes->At(static_cast<std::size_t>(index)) : nullptr;
+            if (!node || depth > 64)
+                return Fail("bad node hierarchy");
+
+            glm::mat4 world = parent * LocalMatrix(*node);
+
+            int meshIndex = node->Index("mesh");
+            if (meshIndex >= 0)
+            {
+                const JsonValue* meshes = m_root.Find("meshes");
+                const JsonValue* mesh = meshes ? meshes->At(static_cast<std::size_t>(meshIndex)) : nullptr;
+                if (!mesh || !AppendMesh(*mesh, world))
+                    return m_error.empty() ? Fail("bad mesh index") : false;
+            }
+
+            if (const JsonValue* children = node->Find("children"))
+            {
+                for (const JsonValue& child : children->array)
+                {
+                    if (!VisitNode(static_cast<int>(child.number), world, depth + 1))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        bool GetAccessor(int index, AccessorView& view)
+        {
+            const JsonValue* accessors = m_root.Find("accessors");
+            const JsonValue* accessor = accessors && index >= 0 ? accessors->At(static_cast<std::size_t>(index)) : nullptr;
+            if (!accessor)
+                return Fail("bad accessor index");
+            if (accessor->Find("sparse"))
+                return Fail("sparse accessors are not supported");
+
+            const JsonValue* views = m_root.Find("bufferViews");
+            int viewIndex = accessor->Index("bufferView");
+            const JsonValue* bufferView = views && viewIndex >= 0 ? views->At(static_cast<std::size_t>(viewIndex)) : nullptr;
+            if (!bufferView || bufferView->Index("buffer") != 0)
+                return Fail("accessor outside the GLB binary chunk");
+
+            const JsonValue* type = accessor->Find("type");
+            view.componentType = accessor->Index("componentType");
+            view.components = type ? ComponentCount(type->string) : 0;
+            view.count = static_cast<std::size_t>(accessor->Number("count", 0));
+            const JsonValue* normalized = accessor->Find("normalized");
+            view.normalized = normalized && normalized->boolean;
+
+            std::size_t elementSize = static_cast<std::size_t>(ComponentSize(view.componentType)) * view.components;
+            if (elementSize == 0)
+                return Fail("unsupported accessor type");
+
+            view.stride = static_cast<std::size_t>(bufferView->Number("byteStride", 0));
+            if (view.stride == 0)
+                view.stride = elementSize;
+
+            std::size_t offset = static_cast<std::size_t>(bufferView->Number("byteOffset", 0)) + static_cast<std::size_t>(accessor->Number("byteOffset", 0));
+            std::size_t viewEnd = static_cast<std::size_t>(bufferView->Number("byteOffset", 0)) + static_cast<std::size_t>(bufferView->Number("byteLength", 0));
+            std::size_t needed = view.count == 0 ? 0 : view.stride * (view.count - 1) + elementSize;
+            if (viewEnd > m_binSize || offset + needed > viewEnd)
+                return Fail("accessor out of bounds");
+
+            view.data = m_bin + offset;
+            return true;
+        }
+
+        bool AppendMesh(const JsonValue& mesh, const glm::mat4& world)
+        {
+            const JsonValue* primitives = mesh.Find("primitives");
+            for (std::size_t p = 0; primitives && p < primitives->array.size(); p++)
+            {
+                if (!AppendPrimitive(primitives->array[p], world))
+                    return false;
+            }
+            return true;
+        }
+
+        bool AppendPrimitive(const JsonValue& primitive, const glm::mat4& world)
+        {
+            if (primitive.Number("mode", 4) != 4)
+                return true; // points, lines and strips aren't triangles lists: skipped
+
+            const JsonValue* attributes = primitive.Find("attributes");
+            if (!attributes)
+                return Fail("primitive without attributes");
+
+            AccessorView positions, normals, uvs;
+            int normalIndex = attributes->Index("NORMAL");
+            int uvIndex = attributes->Index("TEXCOORD_0");
+            if (!GetAccessor(attributes->Index("POSITION"), positions) || positions.components != 3
+                || (normalIndex >= 0 && (!GetAccessor(normalIndex, normals) || normals.count != positions.count))
+                || (uvIndex >= 0 && (!GetAccessor(uvIndex, uvs) || uvs.count != positions.count)))
+                return m_error.empty() ? Fail("bad vertex attributes") : false;
+
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+            bool mirrored = glm::determinant(glm::mat3(world)) < 0.0f;
+
+            std::size_t firstVertex = m_out.VertexCount();
+            std::size_t firstIndex = m_out.indices.size();
+            m_out.vertices.resize((firstVertex + positions.count) * FLOATS_PER_VERTEX);
+
+            float* v = m_out.vertices.data() + firstVertex * FLOATS_PER_VERTEX;
+            for (std::size_t i = 0; i < positions.count; i++, v += FLOATS_PER_VERTEX)
+            {
+                glm::vec4 p = world * glm::vec4(positions.Float(i, 0), positions.Float(i, 1), positions.Float(i, 2), 1.0f);
+                glm::vec3 n(0.0f);
+                if (normalIndex >= 0)
+                {
+                    n = normalMatrix * glm::vec3(normals.Float(i, 0), normals.Float(i, 1), normals.Float(i, 2));
+                    float len = glm::length(n);
+                    n = len > 0.0f ? n / len : glm::vec3(0, 1, 0);
+                }
+                v[0] = p.x; v[1] = p.y; v[2] = p.z;
+                v[3] = n.x; v[4] = n.y; v[5] = n.z;
+                v[6] = uvIndex >= 0 ? uvs.Float(i, 0) : 0.0f;
+                v[7] = uvIndex >= 0 ? 1.0f - uvs.Float(i, 1) : 0.0f; // glTF v runs top to bottom
+            }
+
+            int indicesIndex = primitive.Index("indices");
+            if (indicesIndex >= 0)
+            {
+                AccessorView indices;
+                if (!GetAccessor(indicesIndex, indices))
+                    return false;
+                if (indices.components != 1 || indices.componentType == COMPONENT_FLOAT)
+                    return Fail("bad index accessor");
+
+                m_out.indices.reserve(firstIndex + indices.count);
+                for (std::size_t i = 0; i + 2 < indices.count; i += 3)
+                {
+                    std::uint32_t tri[3] = { indices.Index(i), indices.Index(i + 1), indices.Index(i + 2) };
+                    if (tri[0] >= positions.count || tri[1] >= positions.count || tri[2] >= positions.count)
+                        return Fail("index out of range");
+                    if (mirrored)
+                        std::swap(tri[1], tri[2]);
+                    for (std::uint32_t t : tri)
+                        m_out.indices.push_back(static_cast<unsigned int>(firstVertex + t));
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i + 2 < positions.count; i += 3)
+                {
+                    m_out.indices.push_back(static_cast<unsigned int>(firstVertex + i));
+                    m_out.indices.push_back(static_cast<unsigned int>(firstVertex + (mirrored ? i + 2 : i + 1)));
+                    m_out.indices.push_back(static_cast<unsigned int>(firstVertex + (mirrored ? i + 1 : i + 2)));
+                }
+            }
+
+            if (normalIndex < 0)
+                GenerateNormals(m_out, firstIndex, firstVertex, std::vector<std::uint8_t>(positions.count, 1));
+            return true;
+        }
+
+        const JsonValue& m_root;
+        const unsigned char* m_bin;
+        std::size_t m_binSize;
+        MeshData& m_out;
+        std::string m_error;
+    };
+}
+
+bool ImportMesh(const std::string& path, MeshData& out)
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (ext == ".obj")
+        return ImportObj(path, out);
+    if (ext == ".glb")
+        return ImportGlb(path, out);
+
+    std::cerr << "[Mesh] Unsupported mesh format: " << path << "\n";
+    return false;
+}
+
+bool ImportObj(const std::string& path, MeshData& out)
+{
+    out = MeshData();
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+        return false;
+
+    // Split at line starts, a few MB per chunk, at most one chunk per core
+    constexpr std::size_t MIN_CHUNK_BYTES = 4u << 20;
+    const char* data = file.Data();
+    const char* end = data + file.Size();
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t chunkCount = std::clamp<std::size_t>(file.Size() / MIN_CHUNK_BYTES, 1, threads);
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* begin = data;
+    for (std::size_t i = 0; i < chunkCount; i++)
+    {
+        const char* split = i + 1 == chunkCount ? end : data + file.Size() * (i + 1) / chunkCount;
+        if (split < begin)
+            split = begin;
+        const char* eol = static_cast<const char*>(std::memchr(split, '\n', end - split));
+        split = eol ? eol + 1 : end;
+
+        chunks[i].begin = begin;
+        chunks[i].end = split;
+        begin = split;
+    }
+
+    if (chunkCount == 1)
+        ParseObjChunk(chunks[0]);
+    else
+    {
+        std::vector<std::thread> workers;
+        for (ObjChunk& chunk : chunks)
+            workers.emplace_back(ParseObjChunk, std::ref(chunk));
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    // Merge: element offsets per chunk, then every corner made global
+    std::vector<std::size_t> posBase(chunkCount), uvBase(chunkCount), nrmBase(chunkCount);
+    std::size_t positionCount = 0, uvCount = 0, normalCount = 0, cornerCount = 0;
+    for (std::size_t i = 0; i < chunkCount; i++)
+    {
+        if (chunks[i].errorLine != 0)
+        {
+            std::size_t line = chunks[i].errorLine;
+            for (std::size_t c = 0; c < i; c++)
+                line += std::count(chunks[c].begin, chunks[c].end, '\n');
+            std::cerr << "[Mesh] Parse error in " << path << " at line " << line << "\n";
+            return false;
+        }
+        posBase[i] = positionCount;
+        uvBase[i] = uvCount;
+        nrmBase[i] = normalCount;
+        positionCount += chunks[i].positions.size() / 3;
+        uvCount += chunks[i].uvs.size() / 2;
+        normalCount += chunks[i].normals.size() / 3;
+        cornerCount += chunks[i].corners.size() / 3;
+    }
+
+    std::vector<float> positions, uvs, normals;
+    positions.reserve(positionCount * 3);
+    uvs.reserve(uvCount * 2);
+    normals.reserve(normalCount * 3);
+    for (const ObjChunk& chunk : chunks)
+    {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+
+    // Weld (v, vt, vn) into vertices
+    WeldTable table(positionCount);
+    std::vector<std::uint8_t> missingNormal;
+    bool anyMissingNormal = false;
+    out.indices.reserve(cornerCount);
+    out.vertices.reserve(positionCount * FLOATS_PER_VERTEX);
+
+    const std::size_t counts[3] = { positionCount, uvCount, normalCount };
+    for (std::size_t i = 0; i < chunkCount; i++)
+    {
+        const std::size_t bases[3] = { posBase[i], uvBase[i], nrmBase[i] };
+        const std::vector<int>& corners = chunks[i].corners;
+        for (std::size_t c = 0; c < corners.size(); c += 3)
+        {
+            int key[3];
+            for (int k = 0; k < 3; k++)
+            {
+                int index = corners[c + k];
+                long long global = index;
+                if (index <= RELATIVE_MAX)
+                    global = static_cast<long long>(bases[k]) + (index - RELATIVE);
+                if (index != MISSING && (global < 0 || static_cast<std::size_t>(global) >= counts[k]))
+                {
+                    std::cerr << "[Mesh] Face index out of range in " << path << "\n";
+                    out = MeshData();
+                    return false;
+                }
+                key[k] = index == MISSING ? MISSING : static_cast<int>(global);
+            }
+
+            bool inserted = false;
+            std::uint32_t vertex = table.FindOrInsert(key, static_cast<std::uint32_t>(out.VertexCount()), inserted);
+            if (inserted)
+            {
+                const float* p = &positions[static_cast<std::size_t>(key[0]) * 3];
+                const float* t = key[1] >= 0 ? &uvs[static_cast<std::size_t>(key[1]) * 2] : nullptr;
+                const float* n = key[2] >= 0 ? &normals[static_cast<std::size_t>(key[2]) * 3] : nullptr;
+                out.vertices.insert(out.vertices.end(), {
+                    p[0], p[1], p[2],
+                    n ? n[0] : 0.0f, n ? n[1] : 0.0f, n ? n[2] : 0.0f,
+                    t ? t[0] : 0.0f, t ? t[1] : 0.0f });
+                missingNormal.push_back(n ? 0 : 1);
+                anyMissingNormal |= n == nullptr;
+            }
+            out.indices.push_back(vertex);
+        }
+    }
+
+    if (anyMissingNormal)
+        GenerateNormals(out, 0, 0, missingNormal);
+    return true;
+}
+
+bool ImportGlb(const std::string& path, MeshData& out)
+{
+    out = MeshData();
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+        return false;
+
+    auto Read32 = [&](std::size_t offset)
+        {
+            std::uint32_t v = 0;
+            std::memcpy(&v, file.Data() + offset, 4);
+            return v;
+        };
+
+    if (file.Size() < 20 || Read32(0) != GLB_MAGIC || Read32(4) != 2)
+    {
+        std::cerr << "[Mesh] Not a glTF 2.0 binary: " << path << "\n";
+        return false;
+    }
+
+    // chunks: JSON first, then an optional BIN
+    const char* json = nullptr;
+    std::size_t jsonSize = 0;
+    const unsigned char* bin = nullptr;
+    std::size_t binSize = 0;
+    std::size_t total = std::min<std::size_t>(Read32(8), file.Size());
+    for (std::size_t offset = 12; offset + 8 <= total;)
+    {
+        std::size_t length = Read32(offset);
+        std::uint32_t type = Read32(offset + 4);
+        if (length > total - offset - 8)
+            break;
+        if (type == GLB_CHUNK_JSON && !json)
+        {
+            json = file.Data() + offset + 8;
+            jsonSize = length;
+        }
+        else if (type == GLB_CHUNK_BIN && !bin)
+        {
+            bin = reinterpret_cast<const unsigned char*>(file.Data() + offset + 8);
+            binSize = length;
+        }
+        offset += 8 + ((length + 3) & ~std::size_t(3));
+    }
+
+    JsonValue root;
+    if (!json || !JsonParser(json, json + jsonSize).Parse(root) || root.type != JsonValue::Type::Object)
+    {
+        std::cerr << "[Mesh] Bad glTF JSON chunk: " << path << "\n";
+        return false;
+    }
+
+    GlbReader reader(root, bin, binSize, out);
+    if (!reader.Read())
+    {
+        std::cerr << "[Mesh] " << path << ": " << reader.Error() << "\n";
+        out = MeshData();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include "Mesh.h"
+
+// Mesh files -> MeshData (see Mesh.h). Files are memory mapped and numbers parsed
+// with std::from_chars. Missing normals are generated (area weighted), missing uvs
+// are 0. On failure they log, return false and leave out empty.
+//  - .obj: large files are parsed in parallel chunks of lines; position/uv/normal
+//    triplets are welded into unique vertices through a hash table. Polygons are fanned.
+//  - .glb (binary glTF 2.0): triangle primitives of every mesh in the default scene,
+//    node transforms baked in, uvs flipped to GL's bottom-left origin. No external
+//    buffers, no sparse accessors.
+bool ImportMesh(const std::string& path, MeshData& out); // by extension
+bool ImportObj(const std::string& path, MeshData& out);
+bool ImportGlb(const std::string& path, MeshData& out);
@@ -0,0 +1,276 @@
+#include "MeshOptimizer.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+    // FIFO cache as timestamps: a vertex is cached while fewer than size misses happened
+    // since it was loaded (hits don't refresh it)
+    class FifoCache
+    {
+    public:
+        FifoCache(std::size_t vertexCount, unsigned size) : m_loaded(vertexCount, 0), m_size(size) {}
+
+        // true on a miss
+        bool Touch(unsigned int v)
+        {
+            if (m_loaded[v] != 0 && m_time - m_loaded[v] < m_size)
+                return false;
+            m_loaded[v] = ++m_time;
+            return true;
+        }
+
+        // Everything out, without touching every entry
+        void Flush() { m_time += m_size; }
+
+    private:
+        std::vector<std::uint64_t> m_loaded;
+        std::uint64_t m_time = 0;
+        unsigned m_size;
+    };
+}
+
+TriangleAdjacency::TriangleAdjacency(const std::vector<unsigned int>& indices, std::size_t vertexCount)
+    : offsets(vertexCount + 1, 0), triangles(indices.size())
+{
+    for (unsigned int v : indices)
+        offsets[v + 1]++;
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < indices.size(); i++)
+        triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount, unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    if (indices.size() < 3)
+        return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<std::uint8_t> referenced(vertexCount, 0);
+    std::size_t misses = 0, unique = 0;
+    for (unsigned int v : indices)
+    {
+        misses += cache.Touch(v);
+        unique += referenced[v] == 0;
+        referenced[v] = 1;
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(unique);
+    return stats;
+}
+
+// Tipsify (Sander, Nehab, Barczak 2007): fan around a vertex, then continue from the
+// cached neighbour that will stay cached; dead ends fall back to recent vertices, then a scan
+void OptimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount, unsigned cacheSize)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    TriangleAdjacency adjacency(indices, vertexCount);
+    std::vector<unsigned int> live(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++)
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    std::vector<std::uint64_t> cacheTime(vertexCount, 0);
+    std::uint64_t time = cacheSize + 1;
+    std::vector<std::uint8_t> emitted(triangleCount, 0);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    std::size_t cursor = 0; // scan position for dead ends with an empty stack
+    long long fan = indices[0];
+    while (fan >= 0)
+    {
+        candidates.clear();
+        for (unsigned int i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; i++)
+        {
+            unsigned int t = adjacency.triangles[i];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+        }
+
+        // Next fan: the candidate that stays cached longest while its remaining
+        // triangles (2 new vertices each, worst case) go through
+        fan = -1;
+        long long bestPriority = -1;
+        for (unsigned int v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            long long priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                priority = static_cast<long long>(time - cacheTime[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fan = v;
+            }
+        }
+
+        while (fan < 0 && !deadEnd.empty())
+        {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0)
+                fan = v;
+        }
+        while (fan < 0 && cursor < vertexCount)
+        {
+            if (live[cursor] > 0)
+                fan = static_cast<long long>(cursor);
+            cursor++;
+        }
+    }
+
+    indices.swap(result);
+}
+
+void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<float>& vertices, float threshold, unsigned cacheSize)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    const std::size_t vertexCount = vertices.size() / 8;
+    if (triangleCount < 2)
+        return;
+
+    // Hard boundaries: triangles where the cache order restarts (3 misses)
+    std::vector<std::size_t> hard;
+    {
+        FifoCache cache(vertexCount, cacheSize);
+        for (std::size_t t = 0; t < triangleCount; t++)
+        {
+            int misses = cache.Touch(indices[t * 3]) + cache.Touch(indices[t * 3 + 1]) + cache.Touch(indices[t * 3 + 2]);
+            if (misses == 3 || t == 0)
+                hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+    }
+
+    // Soft boundaries: inside each hard cluster, cut as soon as the piece so far is
+    // within threshold of the cluster's own ACMR
+    std::vector<std::size_t> clusters; // start triangles, + triangleCount at the end
+    for (std::size_t h = 0; h + 1 < hard.size(); h++)
+    {
+        std::size_t begin = hard[h], end = hard[h + 1];
+
+        FifoCache cache(vertexCount, cacheSize);
+        std::size_t clusterMisses = 0;
+        for (std::size_t i = begin * 3; i < end * 3; i++)
+            clusterMisses += cache.Touch(indices[i]);
+        float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        cache.Flush();
+        clusters.push_back(begin);
+        std::size_t start = begin, misses = 0;
+        for (std::size_t t = begin; t < end; t++)
+        {
+            misses += cache.Touch(indices[t * 3]) + cache.Touch(indices[t * 3 + 1]) + cache.Touch(indices[t * 3 + 2]);
+            if (t + 1 < end && static_cast<float>(misses) / static_cast<float>(t + 1 - start) <= limit)
+            {
+                clusters.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                cache.Flush();
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    auto Position = [&](unsigned int v) { return glm::vec3(vertices[v * 8], vertices[v * 8 + 1], vertices[v * 8 + 2]); };
+
+    // Mesh centroid, area weighted
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 a = Position(indices[t * 3]), b = Position(indices[t * 3 + 1]), c = Position(indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCenter += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    meshCenter = meshArea > 0.0f ? meshCenter / meshArea : glm::vec3(0.0f);
+
+    // Clusters facing away from the center (and far out) occlude the rest: draw them first
+    const std::size_t clusterCount = clusters.size() - 1;
+    std::vector<float> sortKey(clusterCount);
+    for (std::size_t k = 0; k < clusterCount; k++)
+    {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (std::size_t t = clusters[k]; t < clusters[k + 1]; t++)
+        {
+            glm::vec3 a = Position(indices[t * 3]), b = Position(indices[t * 3 + 1]), c = Position(indices[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a); // length = 2 * area
+            float triArea = glm::length(n);
+            center += (a + b + c) * (triArea / 3.0f);
+            normal += n;
+            area += triArea;
+        }
+        center = area > 0.0f ? center / area : meshCenter;
+        float len = glm::length(normal);
+        sortKey[k] = len > 0.0f ? glm::dot(center - meshCenter, normal / len) : 0.0f;
+    }
+
+    std::vector<std::size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (std::size_t k : order)
+        result.insert(result.end(), indices.begin() + clusters[k] * 3, indices.begin() + clusters[k + 1] * 3);
+    indices.swap(result);
+}
+
+void OptimizeVertexFetch(MeshData& mesh)
+{
+    constexpr unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> remap(mesh.VertexCount(), UNUSED);
+    std::vector<float> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    unsigned int next = 0;
+    for (unsigned int& index : mesh.indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = next++;
+            vertices.insert(vertices.end(), mesh.vertices.begin() + index * 8, mesh.vertices.begin() + index * 8 + 8);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+void OptimizeMesh(MeshData& mesh, VertexCacheStats* before, VertexCacheStats* after)
+{
+    if (before)
+        *before = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+
+    OptimizeVertexCache(mesh.indices, mesh.VertexCount());
+    OptimizeOverdraw(mesh.indices, mesh.vertices);
+    OptimizeVertexFetch(mesh);
+
+    if (after)
+        *after = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+}
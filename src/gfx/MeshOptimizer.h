@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Mesh.h"
+
+// Import/cook-time reordering of MeshData for the GPU. Triangles go into a vertex cache
+// friendly order (Tipsify), then clusters of them are sorted outside-in to cut overdraw,
+// then vertices are laid out in first-use order so fetches stream. The triangles and
+// vertices themselves are unchanged.
+
+constexpr unsigned VERTEX_CACHE_SIZE = 16; // FIFO entries the optimizer and the stats assume
+
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // transformed vertices per triangle (1/2 ideal on big grids, 3 worst)
+    float atvr = 0.0f; // transformed vertices per referenced vertex (1 ideal)
+};
+
+// Triangles around each vertex (CSR): those of v are triangles[offsets[v], offsets[v + 1])
+struct TriangleAdjacency
+{
+    std::vector<unsigned int> offsets; // vertexCount + 1
+    std::vector<unsigned int> triangles;
+
+    TriangleAdjacency(const std::vector<unsigned int>& indices, std::size_t vertexCount);
+};
+
+// Simulated FIFO cache of cacheSize entries
+VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount,
+    unsigned cacheSize = VERTEX_CACHE_SIZE);
+
+void OptimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount,
+    unsigned cacheSize = VERTEX_CACHE_SIZE);
+// Run after OptimizeVertexCache: splits the order into clusters that keep ACMR within
+// threshold of what it was, then sorts the clusters so outward-facing ones draw first.
+// vertices in the Mesh layout (positions read only).
+void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<float>& vertices,
+    float threshold = 1.05f, unsigned cacheSize = VERTEX_CACHE_SIZE);
+// Vertices in first-use order (unreferenced ones dropped), indices remapped
+void OptimizeVertexFetch(MeshData& mesh);
+
+// All three, in order; before/after are filled when given
+void OptimizeMesh(MeshData& mesh, VertexCacheStats* before = nullptr, VertexCacheStats* after = nullptr);
@@ -0,0 +1,270 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // Sum of squared distances to a set of planes, as the symmetric 4x4 matrix
+    // [aa ab ac ad; bb bc bd; cc cd; dd], plus the summed plane weights (areas)
+    struct Quadric
+    {
+        double m[10] = {};
+        double weight = 0.0;
+
+        void AddPlane(const glm::vec3& n, float d, double w)
+        {
+            const double a = n.x, b = n.y, c = n.z, e = d;
+            m[0] += w * a * a; m[1] += w * a * b; m[2] += w * a * c; m[3] += w * a * e;
+            m[4] += w * b * b; m[5] += w * b * c; m[6] += w * b * e;
+            m[7] += w * c * c; m[8] += w * c * e;
+            m[9] += w * e * e;
+            weight += w;
+        }
+
+        void Add(const Quadric& q)
+        {
+            for (int i = 0; i < 10; i++)
+                m[i] += q.m[i];
+            weight += q.weight;
+        }
+
+        // Area-weighted mean squared distance of p to the planes
+        double Error(const glm::vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            double e = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x
+                + m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y
+                + m[7] * z * z + 2.0 * m[8] * z
+                + m[9];
+            return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct PositionKey
+    {
+        std::uint32_t bits[3];
+        bool operator==(const PositionKey& o) const { return std::memcmp(bits, o.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionHash
+    {
+        std::size_t operator()(const PositionKey& k) const
+        {
+            return (k.bits[0] * 73856093u) ^ (k.bits[1] * 19349663u) ^ (k.bits[2] * 83492791u);
+        }
+    };
+
+    struct Collapse
+    {
+        unsigned int from;
+        unsigned int to;
+        double cost;
+    };
+}
+
+float SimplifyMesh(std::vector<unsigned int>& indices, const std::vector<float>& vertices,
+    std::size_t targetIndexCount, float maxError)
+{
+    const std::size_t vertexCount = vertices.size() / 8;
+    if (indices.size() <= targetIndexCount || vertexCount == 0)
+        return 0.0f;
+
+    auto Position = [&](unsigned int v) { return glm::vec3(vertices[v * 8], vertices[v * 8 + 1], vertices[v * 8 + 2]); };
+
+    // Vertices split by attributes share a position: weld them into position groups
+    std::vector<unsigned int> group(vertexCount);
+    std::vector<unsigned int> groupSize;
+    {
+        std::unordered_map<PositionKey, unsigned int, PositionHash> groups;
+        groups.reserve(vertexCount);
+        for (std::size_t v = 0; v < vertexCount; v++)
+        {
+            PositionKey key;
+            std::memcpy(key.bits, &vertices[v * 8], sizeof(key.bits));
+            auto [it, inserted] = groups.try_emplace(key, static_cast<unsigned int>(groupSize.size()));
+            if (inserted)
+                groupSize.push_back(0);
+            group[v] = it->second;
+            groupSize[it->second]++;
+        }
+    }
+    const std::size_t groupCount = groupSize.size();
+
+    // Locked: seams (more than one vertex per position) and ends of border or
+    // non-manifold edges; they can be collapsed onto, never moved
+    std::vector<std::uint8_t> locked(vertexCount, 0);
+    {
+        std::unordered_map<std::uint64_t, unsigned int> edgeUse;
+        edgeUse.reserve(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                std::uint64_t a = group[indices[i + k]], b = group[indices[i + (k + 1) % 3]];
+                edgeUse[std::min(a, b) << 32 | std::max(a, b)]++;
+            }
+        }
+
+        std::vector<std::uint8_t> groupLocked(groupCount, 0);
+        for (const auto& [edge, uses] : edgeUse)
+        {
+            if (uses != 2)
+            {
+                groupLocked[edge >> 32] = 1;
+                groupLocked[edge & 0xFFFFFFFFu] = 1;
+            }
+        }
+        for (std::size_t v = 0; v < vertexCount; v++)
+            locked[v] = groupLocked[group[v]] || groupSize[group[v]] > 1;
+    }
+
+    std::vector<Quadric> quadrics(groupCount);
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        glm::vec3 a = Position(indices[i]), b = Position(indices[i + 1]), c = Position(indices[i + 2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if (length <= 0.0f)
+            continue;
+        n /= length;
+        Quadric q;
+        q.AddPlane(n, -glm::dot(n, a), 0.5 * length);
+        for (int k = 0; k < 3; k++)
+            quadrics[group[indices[i + k]]].Add(q);
+    }
+
+    const double maxCost = static_cast<double>(maxError) * maxError;
+    double worst = 0.0;
+    std::vector<std::uint8_t> dead(indices.size() / 3, 0);
+    std::vector<std::uint8_t> touched(vertexCount);
+    std::vector<Collapse> collapses;
+    std::size_t liveIndices = indices.size();
+
+    // Passes of independent collapses, cheapest first; a vertex whose neighbourhood
+    // changed waits for the next pass so costs and flip checks stay exact
+    while (liveIndices > targetIndexCount)
+    {
+        const TriangleAdjacency adjacency(indices, vertexCount);
+        const std::vector<unsigned int>& offsets = adjacency.offsets;
+        const std::vector<unsigned int>& around = adjacency.triangles;
+
+        collapses.clear();
+        for (std::size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int a = indices[i + k], b = indices[i + (k + 1) % 3];
+                if (group[a] == group[b])
+                    continue;
+
+                Quadric q = quadrics[group[a]];
+                q.Add(quadrics[group[b]]);
+                double toB = locked[a] ? -1.0 : q.Error(Position(b));
+                double toA = locked[b] ? -1.0 : q.Error(Position(a));
+                if (toB >= 0.0 && (toA < 0.0 || toB <= toA))
+                    collapses.push_back({ a, b, toB });
+                else if (toA >= 0.0)
+                    collapses.push_back({ b, a, toA });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        std::fill(touched.begin(), touched.end(), std::uint8_t(0));
+        std::size_t collapsed = 0;
+        for (const Collapse& c : collapses)
+        {
+            if (c.cost > maxCost || liveIndices <= targetIndexCount)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            // Reject collapses that flip (or flatten) a remaining triangle around from
+            const glm::vec3 target = Position(c.to);
+            bool flips = false;
+            for (unsigned int j = offsets[c.from]; j < offsets[c.from + 1] && !flips; j++)
+            {
+                const unsigned int* t = &indices[around[j] * 3];
+                if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                    continue;
+
+                glm::vec3 p[3] = { Position(t[0]), Position(t[1]), Position(t[2]) };
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (int k = 0; k < 3; k++)
+                {
+                    if (t[k] == c.from)
+                        p[k] = target;
+                }
+                glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                flips = glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+            }
+            if (flips)
+                continue;
+
+            for (unsigned int j = offsets[c.from]; j < offsets[c.from + 1]; j++)
+            {
+                unsigned int* t = &indices[around[j] * 3];
+                for (int k = 0; k < 3; k++)
+                {
+                    touched[t[k]] = 1;
+                    if (t[k] == c.from)
+                        t[k] = c.to;
+                }
+                if (!dead[around[j]] && (t[0] == t[1] || t[1] == t[2] || t[0] == t[2]))
+                {
+                    dead[around[j]] = 1;
+                    liveIndices -= 3;
+                }
+            }
+            quadrics[group[c.to]].Add(quadrics[group[c.from]]);
+            worst = std::max(worst, c.cost);
+            collapsed++;
+        }
+
+        std::size_t out = 0;
+        for (std::size_t t = 0; t < dead.size(); t++)
+        {
+            if (dead[t])
+                continue;
+            for (int k = 0; k < 3; k++)
+                indices[out + k] = indices[t * 3 + k];
+            out += 3;
+        }
+        indices.resize(out);
+        dead.assign(out / 3, 0);
+
+        if (collapsed == 0)
+            break;
+    }
+
+    return static_cast<float>(std::sqrt(worst));
+}
+
+void GenerateLods(MeshData& mesh, int maxLevels)
+{
+    mesh.lods.clear();
+    std::size_t previous = mesh.indices.size();
+    float previousError = 0.0f;
+
+    for (int level = 1; level < std::min(maxLevels, MAX_MESH_LODS); level++)
+    {
+        // from LOD 0 every time, so each level's error is measured against the original
+        MeshLodData lod;
+        lod.indices = mesh.indices;
+        std::size_t target = previous / 6 * 3;
+        lod.error = std::max(previousError, SimplifyMesh(lod.indices, mesh.vertices, target));
+
+        // not worth another level (locked seams/borders or nothing left to remove)
+        if (lod.indices.empty() || lod.indices.size() * 5 > previous * 4)
+            break;
+
+        OptimizeVertexCache(lod.indices, mesh.VertexCount());
+        previous = lod.indices.size();
+        previousError = lod.error;
+        mesh.lods.push_back(std::move(lod));
+    }
+}
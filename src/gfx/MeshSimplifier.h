@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Mesh.h"
+
+// Import/cook-time level-of-detail generation. Edge collapses ordered by quadric error
+// (Garland, Heckbert 1997) shrink the index list only: every LOD draws from the same
+// vertices as LOD 0, so the levels share one vertex buffer. Vertices on borders and on
+// attribute seams (uv / normal splits) are never moved, so levels stay crack free.
+
+// Removes triangles until at most targetIndexCount indices are left or the next
+// collapse would move the surface further than maxError (object space units).
+// Returns the largest error accepted (0 when nothing was collapsed).
+// vertices in the Mesh layout (positions read only).
+float SimplifyMesh(std::vector<unsigned int>& indices, const std::vector<float>& vertices,
+    std::size_t targetIndexCount, float maxError = 1e30f);
+
+// Appends up to MAX_MESH_LODS - 1 coarser levels to mesh.lods, each with about half
+// the triangles of the previous one; stops early once a level barely shrinks.
+// Run after OptimizeMesh (each level gets its own vertex cache pass here).
+void GenerateLods(MeshData& mesh, int maxLevels = MAX_MESH_LODS);
@@ -0,0 +1,327 @@
+#include "PointShadowMap.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "InstanceBatcher.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <bit>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+static const GLuint ALL_FACES = 0x3F;
+
+static const char* FACE_NAMES[6] = {
+    "ShadowFace +X", "ShadowFace -X", "ShadowFace +Y", "ShadowFace -Y", "ShadowFace +Z", "ShadowFace -Z"
+};
+
+// layout(location = 0) in shadow_cube.vert
+static const GLint FACE_UNIFORM_LOC = 0;
+
+static GLuint CreateDepthCube(unsigned size)
+{
+    // immutable storage for all 6 faces at once, set up without binding it anywhere
+    GLuint cube = 0;
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &cube);
+    glTextureStorage2D(cube, 1, GL_DEPTH_COMPONENT24, size, size);
+
+    glTextureParameteri(cube, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(cube, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(cube, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(cube, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(cube, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return cube;
+}
+
+PointShadowMap::PointShadowMap(const std::string& shaderDir, unsigned size, float nearPlane, float farPlane)
+    : m_size(size), m_near(nearPlane), m_far(farPlane)
+{
+    glGenFramebuffers(1, &m_fbo);
+    m_cube = CreateDepthCube(m_size);
+    m_staticCube = CreateDepthCube(m_size);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cube, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Shadow cubemap FBO incomplete!\n";
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    m_perFace = ShaderProgram(shaderDir + "/shadow_cube.vert", shaderDir + "/shadow_cube.frag");
+    m_geometry = ShaderProgram(shaderDir + "/shadow_cube_layered.vert",
+        shaderDir + "/shadow_cube.geom", shaderDir + "/shadow_cube.frag");
+
+    // gl_Layer from the vertex shader needs the extension; don't even try to compile without it
+    m_vertexLayerSupported = HasGLExtension("GL_ARB_shader_viewport_layer_array");
+    if (m_vertexLayerSupported)
+    {
+        m_vertexLayer = ShaderProgram(shaderDir + "/shadow_cube_layer.vert", shaderDir + "/shadow_cube.frag");
+        m_vertexLayerSupported = m_vertexLayer.Id() != 0;
+    }
+}
+
+PointShadowMap::~PointShadowMap()
+{
+    if (m_fbo != 0) glDeleteFramebuffers(1, &m_fbo);
+    for (GLuint cube : { m_cube, m_staticCube })
+    {
+        if (cube == 0) continue;
+        glDeleteTextures(1, &cube);
+        GLState::Get().OnDeleteTexture(cube);
+    }
+}
+
+void PointShadowMap::BeginReloadShaders(const std::string& changedPath)
+{
+    auto Begin = [&](ShaderProgram& program)
+        {
+            if (changedPath.empty() || program.UsesFile(changedPath))
+                program.BeginReload();
+        };
+    Begin(m_perFace);
+    Begin(m_geometry);
+    if (m_vertexLayerSupported)
+        Begin(m_vertexLayer);
+}
+
+void PointShadowMap::PollShaders()
+{
+    bool swapped = m_perFace.PollReload();
+    swapped |= m_geometry.PollReload();
+    swapped |= m_vertexLayer.PollReload();
+
+    // cached static depth came from the old program
+    if (swapped)
+        m_staticValid = false;
+}
+
+void PointShadowMap::SetCaching(bool enabled)
+{
+    m_caching = enabled;
+    m_staticValid = false;
+}
+
+bool PointShadowMap::IsSupported(ShadowPath path) const
+{
+    switch (path)
+    {
+    case ShadowPath::PerFace:        return m_perFace.Id() != 0;
+    case ShadowPath::GeometryShader: return m_geometry.Id() != 0;
+    case ShadowPath::VertexLayer:    return m_vertexLayerSupported && m_vertexLayer.Id() != 0;
+    }
+    return false;
+}
+
+ShadowPath PointShadowMap::SetPath(ShadowPath path)
+{
+    m_path = IsSupported(path) ? path : ShadowPath::PerFace;
+    return m_path;
+}
+
+ShadowPath PointShadowMap::BestPath() const
+{
+    if (IsSupported(ShadowPath::VertexLayer)) return ShadowPath::VertexLayer;
+    if (IsSupported(ShadowPath::GeometryShader)) return ShadowPath::GeometryShader;
+    return ShadowPath::PerFace;
+}
+
+const char* PointShadowMap::PathName(ShadowPath path)
+{
+    switch (path)
+    {
+    case ShadowPath::PerFace:        return "per-face";
+    case ShadowPath::GeometryShader: return "geometry-shader";
+    case ShadowPath::VertexLayer:    return "vertex-layer";
+    }
+    return "?";
+}
+
+void PointShadowMap::SetLight(const glm::vec3& lightPos)
+{
+    if (lightPos != m_lightPos)
+        m_staticValid = false;
+    m_lightPos = lightPos;
+
+    glm::mat4 lightProj = glm::perspective(glm::radians(90.0f), 1.0f, m_near, m_far);
+    m_faceVP[0] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3( 1, 0, 0), glm::vec3(0,-1, 0));
+    m_faceVP[1] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1, 0, 0), glm::vec3(0,-1, 0));
+    m_faceVP[2] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0, 1, 0), glm::vec3(0, 0, 1));
+    m_faceVP[3] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0,-1, 0), glm::vec3(0, 0,-1));
+    m_faceVP[4] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0, 0, 1), glm::vec3(0,-1, 0));
+    m_faceVP[5] = lightProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0, 0,-1), glm::vec3(0,-1, 0));
+
+    ShadowBlock block;
+    for (int face = 0; face < 6; face++)
+    {
+        m_faceFrustum[face] = Frustum::FromViewProj(m_faceVP[face]);
+        block.faceVP[face] = m_faceVP[face];
+    }
+    m_shadowUbo.Update(block);
+
+    m_casters.Clear();
+    m_staticCasters.Clear();
+    m_dynamicFaces = 0;
+}
+
+GLuint PointShadowMap::AddCaster(const Mesh* mesh, const glm::mat4& model, const AABB& worldBounds, bool isStatic, int lod)
+{
+    if (isStatic && !NeedsStaticCasters())
+        return 0;
+
+    GLuint mask = 0;
+    for (int face = 0; face < 6; face++)
+    {
+        if (m_faceFrustum[face].Intersects(worldBounds))
+            mask |= 1u << face;
+    }
+
+    RenderStats& stats = GetRenderStats();
+    stats.shadowTested++;
+    if (mask == 0)
+    {
+        stats.shadowCulled++;
+        return 0;
+    }
+    stats.shadowFaces += std::popcount(mask);
+    stats.shadowLodReduced += lod > 0;
+
+    // depth only: the normal matrix is never read
+    if (isStatic && m_caching)
+    {
+        m_staticCasters.Add(mesh, model, glm::mat3(1.0f), true, mask, lod);
+    }
+    else
+    {
+        m_casters.Add(mesh, model, glm::mat3(1.0f), true, mask, lod);
+        m_dynamicFaces |= mask;
+    }
+    return mask;
+}
+
+ShaderProgram& PointShadowMap::ActiveProgram()
+{
+    switch (m_path)
+    {
+    case ShadowPath::GeometryShader: return m_geometry;
+    case ShadowPath::VertexLayer:    return m_vertexLayer;
+    default:                         return m_perFace;
+    }
+}
+
+void PointShadowMap::DrawCasters(InstanceBatcher& casters, GLuint cube, GLuint faces, bool clear)
+{
+    // The GS reads the face mask per instance; the other paths want one instance per face
+    casters.Build(m_path != ShadowPath::GeometryShader);
+
+    if (m_path == ShadowPath::PerFace)
+    {
+        for (int face = 0; face < 6; face++)
+        {
+            if ((faces & (1u << face)) == 0)
+                continue;
+
+            PROFILE_SCOPE(FACE_NAMES[face]);
+
+            glUniform1i(FACE_UNIFORM_LOC, face);
+
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cube, 0);
+            if (clear)
+                glClear(GL_DEPTH_BUFFER_BIT);
+
+            casters.DrawLayer(face);
+        }
+    }
+    else if (faces != 0)
+    {
+        // Whole cube attached as a layered target: one clear, one submission
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cube, 0);
+        if (clear)
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+        casters.Draw();
+    }
+}
+
+void PointShadowMap::Render()
+{
+    PROFILE_SCOPE("ShadowCube");
+
+    glViewport(0, 0, m_size, m_size);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+
+    // Optional: reduce acne
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+
+    ActiveProgram().Use();
+
+    if (!m_caching)
+    {
+        DrawCasters(m_casters, m_cube, ALL_FACES, true);
+    }
+    else
+    {
+        // Faces holding last frame's dynamic casters must be reset too
+        GLuint restore = m_dynamicFacesPrev | m_dynamicFaces;
+        if (!m_staticValid)
+        {
+            PROFILE_SCOPE("ShadowStatic");
+            DrawCasters(m_staticCasters, m_staticCube, ALL_FACES, true);
+            m_staticValid = true;
+            restore = ALL_FACES;
+        }
+
+        // Depth is order independent, so static copy + dynamic on top == full redraw
+        for (int face = 0; face < 6; face++)
+        {
+            if (restore & (1u << face))
+                glCopyImageSubData(m_staticCube, GL_TEXTURE_CUBE_MAP, 0, 0, 0, face,
+                    m_cube, GL_TEXTURE_CUBE_MAP, 0, 0, 0, face, m_size, m_size, 1);
+        }
+        GetRenderStats().shadowFacesRestored += std::popcount(restore);
+
+        DrawCasters(m_casters, m_cube, m_dynamicFaces, false);
+        m_dynamicFacesPrev = m_dynamicFaces;
+    }
+
+    glCullFace(GL_BACK);
+}
+
+void PointShadowMap::RenderExternal(const std::function<void()>& drawCasters)
+{
+    PROFILE_SCOPE("ShadowCube");
+
+    glViewport(0, 0, m_size, m_size);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+
+    if (m_path == ShadowPath::PerFace || m_geometry.Id() == 0)
+    {
+        m_perFace.Use();
+        for (int face = 0; face < 6; face++)
+        {
+            PROFILE_SCOPE(FACE_NAMES[face]);
+            glUniform1i(FACE_UNIFORM_LOC, face);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, m_cube, 0);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawCasters();
+        }
+    }
+    else
+    {
+        m_geometry.Use();
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cube, 0);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        drawCasters();
+    }
+
+    // m_cube no longer holds the cached static depth + dynamic faces
+    m_staticValid = false;
+
+    glCullFace(GL_BACK);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <functional>
+#include <string>
+#include "ShaderProgram.h"
+#include "InstanceBatcher.h"
+#include "Bounds.h"
+#include "UniformBlocks.h"
+#include "Mesh.h"
+
+// How the 6 cube faces get rendered
+enum class ShadowPath
+{
+    PerFace,        // 6 passes, one face attached at a time (always available)
+    GeometryShader, // 1 pass, GS with 6 invocations routes triangles via gl_Layer
+    VertexLayer     // 1 pass, one instance per (caster, face), VS writes gl_Layer (ARB_shader_viewport_layer_array)
+};
+
+// Omnidirectional shadow for a point light: depth cubemap storing linear
+// distance / far plane (see shadow_cube.frag).
+class PointShadowMap
+{
+public:
+    // shaderDir holds the shadow_cube* shaders
+    PointShadowMap(const std::string& shaderDir, unsigned size, float nearPlane, float farPlane);
+    ~PointShadowMap();
+
+    PointShadowMap(const PointShadowMap&) = delete;
+    PointShadowMap& operator=(const PointShadowMap&) = delete;
+
+    // False if the per-face program (the fallback) failed to build
+    bool IsValid() const { return m_perFace.Id() != 0; }
+
+    // Async reload of the programs using changedPath (all of them if empty);
+    // PollShaders() once per frame swaps finished ones in
+    void BeginReloadShaders(const std::string& changedPath = {});
+    void PollShaders();
+
+    bool IsSupported(ShadowPath path) const;
+    // Unsupported paths fall back to PerFace; returns the path actually selected
+    ShadowPath SetPath(ShadowPath path);
+    ShadowPath Path() const { return m_path; }
+    static const char* PathName(ShadowPath path);
+    // Fastest supported single-pass path
+    ShadowPath BestPath() const;
+
+    // Cached mode (default): static casters are drawn into their own cube only when the
+    // light moves or the cache is invalidated. Each frame the faces touched by dynamic
+    // casters are restored from it and the dynamic casters drawn on top.
+    void SetCaching(bool enabled);
+    bool Caching() const { return m_caching; }
+    // Call (before AddCaster) when a static caster moved, appeared or went away
+    void InvalidateStaticCache() { m_staticValid = false; }
+    // False while the static cube is valid: static casters can be skipped entirely
+    bool NeedsStaticCasters() const { return !m_caching || !m_staticValid; }
+
+    // Once per frame before AddCaster: moves the light and drops last frame's casters
+    void SetLight(const glm::vec3& lightPos);
+    const glm::mat4& FaceViewProj(int face) const { return m_faceVP[face]; }
+    const Frustum& FaceFrustum(int face) const { return m_faceFrustum[face]; }
+
+    // Culls worldBounds against the 6 face frusta (their far planes also cap the light range).
+    // Returns the mask of faces it lands in; 0 = not drawn at all (or a cached static caster).
+    // lod should only depend on the light and the caster (MakeLodSelector()), or the
+    // static cube would go stale when the camera moves.
+    GLuint AddCaster(const Mesh* mesh, const glm::mat4& model, const AABB& worldBounds, bool isStatic = false, int lod = 0);
+
+    // LOD choice as seen from the light: one cube face is 90 degrees over Size() pixels
+    LodSelector MakeLodSelector(float maxPixelError) const { return { m_lightPos, m_size * 0.5f, maxPixelError }; }
+
+    // Renders this frame's casters, each only into the faces it touches. The Light block
+    // (UniformBinding::Light) must be current. Leaves the shadow FBO bound and
+    // front-face culling off; the caller restores its own target/viewport.
+    void Render();
+
+    // Renders casters that don't go through AddCaster (GpuScene): clears the whole cube and
+    // calls drawCasters with the shadow program bound, once per face (uFace set) on the
+    // per-face path, once with the cube layered on the others. The instances' layer masks
+    // must be valid: shadow_cube.vert clips instances outside uFace, and the vertex-layer
+    // path (one instance per face) is replaced by the geometry shader. No static caching: the next Render() redraws the static cube.
+    void RenderExternal(const std::function<void()>& drawCasters);
+
+    GLuint CubeTexture() const { return m_cube; }
+    float FarPlane() const { return m_far; }
+    unsigned Size() const { return m_size; }
+
+private:
+    ShaderProgram& ActiveProgram();
+    // Draws casters into the given faces of cube (program and FBO already bound)
+    void DrawCasters(InstanceBatcher& casters, GLuint cube, GLuint faces, bool clear);
+
+    unsigned m_size = 0;
+    float m_near = 0.0f;
+    float m_far = 0.0f;
+
+    GLuint m_fbo = 0;
+    GLuint m_cube = 0;        // what the lit pass samples
+    GLuint m_staticCube = 0;  // cached mode: static casters only
+
+    ShaderProgram m_perFace;
+    ShaderProgram m_geometry;
+    ShaderProgram m_vertexLayer;
+    bool m_vertexLayerSupported = false;
+    ShadowPath m_path = ShadowPath::PerFace;
+
+    glm::vec3 m_lightPos{ 0.0f };
+    glm::mat4 m_faceVP[6];
+    UniformBuffer<ShadowBlock> m_shadowUbo{ UniformBinding::Shadow };
+    Frustum m_faceFrustum[6];
+
+    InstanceBatcher m_casters;       // dynamic (everything when not caching)
+    InstanceBatcher m_staticCasters;
+    GLuint m_dynamicFaces = 0;       // faces touched by this frame's dynamic casters
+    GLuint m_dynamicFacesPrev = 0;
+    bool m_caching = true;
+    bool m_staticValid = false;
+};
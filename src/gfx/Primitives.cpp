@@ -1,4 +1,6 @@
 #include "Primitives.h"
+#include <glm/glm.hpp>
+#include <cmath>
 
 Mesh CreateCube()
 {
@@ -51,3 +53,40 @@ Mesh CreateCube()
 
     return Mesh(vertices, sizeof(vertices), indices, sizeof(indices), 36);
 }
+
+void FillWaveGrid(MeshData& data, int n, float time)
+{
+    const float amplitude = 0.06f;
+    const float step = 1.0f / static_cast<float>(n - 1);
+
+    data.vertices.resize(static_cast<std::size_t>(n) * n * 8);
+    float* v = data.vertices.data();
+    for (int z = 0; z < n; z++)
+    {
+        for (int x = 0; x < n; x++, v += 8)
+        {
+            float px = x * step - 0.5f, pz = z * step - 0.5f;
+            float a = 8.0f * px + 2.0f * time, b = 6.0f * pz + 1.3f * time;
+            // normal from the height's partial derivatives
+            glm::vec3 normal = glm::normalize(glm::vec3(-amplitude * 8.0f * std::cos(a), 1.0f, -amplitude * 6.0f * std::cos(b)));
+
+            v[0] = px; v[1] = amplitude * (std::sin(a) + std::sin(b)); v[2] = pz;
+            v[3] = normal.x; v[4] = normal.y; v[5] = normal.z;
+            v[6] = x * step; v[7] = z * step;
+        }
+    }
+
+    if (!data.indices.empty())
+        return;
+    data.indices.reserve(static_cast<std::size_t>(n - 1) * (n - 1) * 6);
+    for (int z = 0; z + 1 < n; z++)
+    {
+        for (int x = 0; x + 1 < n; x++)
+        {
+            // counter-clockwise seen from +Y
+            unsigned int i = static_cast<unsigned int>(z * n + x);
+            unsigned int row = static_cast<unsigned int>(n);
+            data.indices.insert(data.indices.end(), { i, i + row, i + 1, i + 1, i + row, i + row + 1 });
+        }
+    }
+}
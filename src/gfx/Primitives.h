@@ -1,4 +1,9 @@
 #pragma once
 #include "Mesh.h"
 
-Mesh CreateCube();
\ No newline at end of file
+Mesh CreateCube();
+
+// n x n vertex sheet over [-0.5, 0.5]^2 in XZ, displaced in Y by two travelling sine
+// waves at time (dynamic geometry for Mesh::UpdateVertices). Indices are only written
+// while data has none, so refilling every frame only rewrites the vertices.
+void FillWaveGrid(MeshData& data, int n, float time);
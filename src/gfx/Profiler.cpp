@@ -0,0 +1,231 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+std::int64_t Profiler::CpuNowNs() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::StartCapture(const std::string& path, int frameCount)
+{
+    if (m_capturing || !m_capturePath.empty())
+    {
+        std::cerr << "[Profiler] Capture already in progress, ignoring request.\n";
+        return;
+    }
+
+    m_capturePath = path;
+    m_captureEndFrame = m_frame + static_cast<std::uint64_t>(std::max(frameCount, 1));
+    m_captured.clear();
+    m_capturing = true;
+
+    // Map GPU timestamps onto the CPU clock (one sync query per capture is fine)
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    m_gpuToCpuOffsetNs = CpuNowNs() - gpuNow;
+
+    std::cout << "[Profiler] Capturing " << (m_captureEndFrame - m_frame) << " frames -> " << path << "\n";
+}
+
+void Profiler::BeginFrame()
+{
+    FrameSlot& finished = CurrentSlot();
+    if (!finished.events.empty())
+        finished.pending = true;
+    m_openScopes.clear();
+
+    m_frame++;
+    if (m_capturing && m_frame >= m_captureEndFrame)
+        m_capturing = false;
+
+    // The slot we are about to reuse is FRAMES_IN_FLIGHT frames old. If the GPU is
+    // still behind, give up on its GPU times instead of waiting.
+    FrameSlot& next = CurrentSlot();
+    if (next.pending && !TryResolve(next, false))
+    {
+        for (Event& e : next.events)
+            e.gpuBegin = e.gpuEnd = -1;
+        next.usedQueries = 0;
+        TryResolve(next, false);
+    }
+    next.frame = m_frame;
+    next.usedQueries = 0;
+    next.events.clear();
+
+    bool capturePending = false;
+    for (FrameSlot& slot : m_slots)
+    {
+        if (slot.pending && !TryResolve(slot, false))
+            capturePending |= slot.frame < m_captureEndFrame;
+    }
+
+    if (!m_capturing && !m_capturePath.empty() && !capturePending)
+        WriteCapture();
+}
+
+void Profiler::Flush()
+{
+    FrameSlot& current = CurrentSlot();
+    if (!current.events.empty())
+        current.pending = true;
+    m_openScopes.clear();
+
+    for (FrameSlot& slot : m_slots)
+    {
+        if (slot.pending)
+            TryResolve(slot, true);
+    }
+    current.events.clear();
+    current.usedQueries = 0;
+
+    m_capturing = false;
+    if (!m_capturePath.empty())
+        WriteCapture();
+}
+
+void Profiler::Shutdown()
+{
+    for (FrameSlot& slot : m_slots)
+    {
+        if (!slot.queries.empty())
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        slot = FrameSlot{};
+    }
+}
+
+void Profiler::PushScope(const char* name, bool gpu)
+{
+    FrameSlot& slot = CurrentSlot();
+
+    Event e;
+    e.name = name;
+    e.depth = static_cast<std::uint32_t>(m_openScopes.size());
+    e.cpuBeginNs = CpuNowNs();
+    if (gpu)
+        e.gpuBegin = IssueTimestamp(slot);
+
+    m_openScopes.push_back(static_cast<std::uint32_t>(slot.events.size()));
+    slot.events.push_back(e);
+}
+
+void Profiler::PopScope()
+{
+    if (m_openScopes.empty())
+        return;
+
+    FrameSlot& slot = CurrentSlot();
+    Event& e = slot.events[m_openScopes.back()];
+    m_openScopes.pop_back();
+
+    if (e.gpuBegin >= 0)
+    {
+        e.gpuEnd = IssueTimestamp(slot);
+        if (e.gpuEnd < 0)
+            e.gpuBegin = -1;
+    }
+    e.cpuEndNs = CpuNowNs();
+}
+
+int Profiler::IssueTimestamp(FrameSlot& slot)
+{
+    if (slot.usedQueries >= MAX_QUERIES_PER_FRAME)
+        return -1;
+
+    if (slot.usedQueries == static_cast<int>(slot.queries.size()))
+    {
+        GLuint q = 0;
+        glGenQueries(1, &q);
+        slot.queries.push_back(q);
+    }
+
+    glQueryCounter(slot.queries[slot.usedQueries], GL_TIMESTAMP);
+    return slot.usedQueries++;
+}
+
+bool Profiler::TryResolve(FrameSlot& slot, bool wait)
+{
+    if (slot.usedQueries > 0 && !wait)
+    {
+        // Queries complete in order: the last one being ready means all are
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    for (Event& e : slot.events)
+    {
+        if (e.gpuBegin < 0 || e.gpuEnd < 0)
+            continue;
+
+        GLint64 begin = 0, end = 0;
+        glGetQueryObjecti64v(slot.queries[e.gpuBegin], GL_QUERY_RESULT, &begin);
+        glGetQueryObjecti64v(slot.queries[e.gpuEnd], GL_QUERY_RESULT, &end);
+        e.gpuBeginNs = begin;
+        e.gpuEndNs = end;
+    }
+
+    if (!m_capturePath.empty() && slot.frame < m_captureEndFrame)
+    {
+        for (const Event& e : slot.events)
+            m_captured.push_back({ e, slot.frame });
+    }
+
+    slot.pending = false;
+    return true;
+}
+
+void Profiler::WriteCapture()
+{
+    std::ofstream file(m_capturePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open file: " << m_capturePath << "\n";
+    }
+    else
+    {
+        std::int64_t origin = INT64_MAX;
+        for (const ResolvedEvent& r : m_captured)
+            origin = std::min(origin, r.event.cpuBeginNs);
+
+        auto toUs = [&](std::int64_t ns) { return static_cast<double>(ns - origin) / 1000.0; };
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+        file.setf(std::ios::fixed);
+        file.precision(3);
+        for (const ResolvedEvent& r : m_captured)
+        {
+            const Event& e = r.event;
+            file << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                << ",\"ts\":" << toUs(e.cpuBeginNs) << ",\"dur\":" << (e.cpuEndNs - e.cpuBeginNs) / 1000.0
+                << ",\"args\":{\"frame\":" << r.frame << ",\"depth\":" << e.depth << "}}";
+
+            if (e.gpuBegin >= 0 && e.gpuEnd >= 0)
+            {
+                file << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+                    << ",\"ts\":" << toUs(e.gpuBeginNs + m_gpuToCpuOffsetNs)
+                    << ",\"dur\":" << (e.gpuEndNs - e.gpuBeginNs) / 1000.0
+                    << ",\"args\":{\"frame\":" << r.frame << ",\"depth\":" << e.depth << "}}";
+            }
+        }
+        file << "\n]}\n";
+
+        std::cout << "[Profiler] Wrote " << m_captured.size() << " scopes to " << m_capturePath << "\n";
+    }
+
+    m_capturePath.clear();
+    m_captured.clear();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame profiler: nested CPU scopes plus GPU timestamps (glQueryCounter) kept in a
+// ring of frames in flight. A frame's GPU results are only read once its last query
+// reports GL_QUERY_RESULT_AVAILABLE, so resolving never stalls the pipeline.
+// Nothing is recorded outside of a capture; a capture writes one Chrome trace_event
+// JSON file (open in chrome://tracing or ui.perfetto.dev).
+class Profiler
+{
+public:
+    static Profiler& Get();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Starts recording now and for the next frameCount frames, then writes path
+    void StartCapture(const std::string& path, int frameCount);
+    bool IsCapturing() const { return m_capturing; }
+
+    // Call once per frame before any scope; resolves finished frames
+    void BeginFrame();
+
+    // Blocks until every pending query is done and writes an open capture (use at shutdown)
+    void Flush();
+
+    // Releases the query objects (needs the GL context still current)
+    void Shutdown();
+
+    void PushScope(const char* name, bool gpu);
+    void PopScope();
+
+private:
+    Profiler() = default;
+
+    static constexpr int FRAMES_IN_FLIGHT = 4;
+    static constexpr int MAX_QUERIES_PER_FRAME = 512;
+
+    struct Event
+    {
+        const char* name = nullptr;
+        std::uint32_t depth = 0;
+        std::int64_t cpuBeginNs = 0;
+        std::int64_t cpuEndNs = 0;
+        int gpuBegin = -1; // query index within the frame slot, -1 = CPU only
+        int gpuEnd = -1;
+        std::int64_t gpuBeginNs = 0;
+        std::int64_t gpuEndNs = 0;
+    };
+
+    struct FrameSlot
+    {
+        std::uint64_t frame = 0;
+        bool pending = false;
+        std::vector<GLuint> queries;
+        int usedQueries = 0;
+        std::vector<Event> events;
+    };
+
+    struct ResolvedEvent
+    {
+        Event event;
+        std::uint64_t frame = 0;
+    };
+
+    FrameSlot& CurrentSlot() { return m_slots[m_frame % FRAMES_IN_FLIGHT]; }
+    int IssueTimestamp(FrameSlot& slot);
+    bool TryResolve(FrameSlot& slot, bool wait);
+    void WriteCapture();
+
+    std::int64_t CpuNowNs() const;
+
+    std::array<FrameSlot, FRAMES_IN_FLIGHT> m_slots;
+    std::vector<std::uint32_t> m_openScopes; // indices into CurrentSlot().events
+    std::uint64_t m_frame = 0;
+
+    bool m_capturing = false;
+    std::string m_capturePath;
+    std::uint64_t m_captureEndFrame = 0; // exclusive
+    std::vector<ResolvedEvent> m_captured;
+    std::int64_t m_gpuToCpuOffsetNs = 0;  // gpu timestamp + offset = cpu clock
+};
+
+// RAII scope: PROFILE_SCOPE("Name") for CPU+GPU, PROFILE_SCOPE_CPU for CPU only.
+// name must outlive the capture (string literals).
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name, bool gpu = true)
+        : m_active(Profiler::Get().IsCapturing())
+    {
+        if (m_active) Profiler::Get().PushScope(name, gpu);
+    }
+
+    ~ProfileScope()
+    {
+        if (m_active) Profiler::Get().PopScope();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    bool m_active;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, true)
+#define PROFILE_SCOPE_CPU(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, false)
@@ -0,0 +1,186 @@
+#include "ProgramCache.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint32_t FILE_MAGIC = 0x4250524D; // "MRPB"
+    constexpr std::uint32_t FILE_VERSION = 1;
+
+    struct FileHeader
+    {
+        std::uint32_t magic = FILE_MAGIC;
+        std::uint32_t version = FILE_VERSION;
+        std::uint32_t format = 0; // GLenum from glGetProgramBinary
+        std::uint32_t length = 0;
+    };
+
+    // FNV-1a, 64 bit
+    std::uint64_t Hash(std::uint64_t h, const std::string& s)
+    {
+        for (unsigned char c : s)
+        {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        // separator so ("ab", "c") and ("a", "bc") differ
+        h ^= 0xFF;
+        h *= 1099511628211ull;
+        return h;
+    }
+
+    std::string GLString(GLenum name)
+    {
+        const GLubyte* s = glGetString(name);
+        return s ? reinterpret_cast<const char*>(s) : "";
+    }
+}
+
+ProgramCache& ProgramCache::Get()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+void ProgramCache::SetDirectory(const std::string& dir)
+{
+    m_dir.clear();
+    if (dir.empty())
+        return;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0)
+    {
+        std::cerr << "[ProgramCache] Driver has no program binary formats, cache disabled.\n";
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec)
+    {
+        std::cerr << "[ProgramCache] Cannot create " << dir << ": " << ec.message() << "\n";
+        return;
+    }
+
+    m_dir = dir;
+    m_driver = GLString(GL_VENDOR) + "|" + GLString(GL_RENDERER) + "|" + GLString(GL_VERSION);
+}
+
+std::uint64_t ProgramCache::Key(const std::string& vs, const std::string& gs, const std::string& fs) const
+{
+    std::uint64_t h = 14695981039346656037ull;
+    h = Hash(h, m_driver);
+    h = Hash(h, vs);
+    h = Hash(h, gs);
+    h = Hash(h, fs);
+    return h;
+}
+
+std::string ProgramCache::PathFor(std::uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_dir) / name).string();
+}
+
+GLuint ProgramCache::Load(std::uint64_t key)
+{
+    if (!IsEnabled())
+        return 0;
+
+    std::string path = PathFor(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        m_misses++;
+        return 0;
+    }
+
+    FileHeader header;
+    std::vector<char> binary;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (file && header.magic == FILE_MAGIC && header.version == FILE_VERSION && header.length > 0)
+    {
+        binary.resize(header.length);
+        file.read(binary.data(), header.length);
+    }
+    bool readOk = file && !binary.empty();
+    file.close();
+
+    GLuint program = 0;
+    if (readOk)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0)
+    {
+        // truncated, old format or rejected by the driver: drop it, it gets rewritten
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        m_misses++;
+        return 0;
+    }
+
+    m_hits++;
+    return program;
+}
+
+void ProgramCache::Store(std::uint64_t key, GLuint program)
+{
+    if (!IsEnabled() || program == 0)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    FileHeader header;
+    header.format = format;
+    header.length = static_cast<std::uint32_t>(written);
+
+    // write next to the final name and rename, so a crash never leaves half a file behind
+    std::string path = PathFor(key);
+    std::string tmpPath = path + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open file: " << tmpPath << "\n";
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        ok = file.good();
+    }
+
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmpPath, path, ec);
+    if (!ok || ec)
+        std::filesystem::remove(tmpPath, ec);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// On-disk cache of linked programs (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by a hash of the final sources (defines already injected)
+// plus GL vendor, renderer and version, so a driver update just misses.
+// Any miss, unreadable file or binary the driver rejects falls back to compiling.
+class ProgramCache
+{
+public:
+    static ProgramCache& Get();
+
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    // Needs a current context; empty dir (the default) disables the cache.
+    // Also disabled when the driver offers no binary formats.
+    void SetDirectory(const std::string& dir);
+    bool IsEnabled() const { return !m_dir.empty(); }
+
+    // gs may be empty
+    std::uint64_t Key(const std::string& vs, const std::string& gs, const std::string& fs) const;
+
+    // Linked program, or 0 on a miss / rejected binary (the stale file is removed)
+    GLuint Load(std::uint64_t key);
+    // Program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void Store(std::uint64_t key, GLuint program);
+
+    std::uint32_t Hits() const { return m_hits; }
+    std::uint32_t Misses() const { return m_misses; }
+
+private:
+    ProgramCache() = default;
+
+    std::string PathFor(std::uint64_t key) const;
+
+    std::string m_dir;
+    std::string m_driver; // vendor + renderer + version, folded into every key
+    std::uint32_t m_hits = 0;
+    std::uint32_t m_misses = 0;
+};
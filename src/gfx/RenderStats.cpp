@@ -0,0 +1,7 @@
+#include "RenderStats.h"
+
+RenderStats& GetRenderStats()
+{
+    static RenderStats stats;
+    return stats;
+}
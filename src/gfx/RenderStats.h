@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// Per-frame counters bumped by the gfx wrappers (reset by the app each frame)
+struct RenderStats
+{
+    std::uint32_t drawCalls = 0;
+    std::uint64_t triangles = 0;
+    std::uint32_t vertexArrayBinds = 0; // VAO switches (one per vertex layout when meshes share the GeometryArena)
+    std::uint32_t indirectCommands = 0; // draws inside glMultiDrawElementsIndirect calls (GpuScene), culled ones included
+
+    // GLState: binds, program switches, texture unit changes and texture parameters
+    // sent to the driver / skipped because they would not change anything
+    std::uint32_t stateCallsIssued = 0;
+    std::uint32_t stateCallsElided = 0;
+
+    // StreamBuffer: bytes written into persistent-mapped rings, and allocations that had
+    // to wait for the GPU to release a region
+    std::uint64_t streamBytes = 0;
+    std::uint32_t streamWaits = 0;
+
+    // Culling: objects tested against the camera / rejected by it, shadow casters
+    // outside all 6 cube faces, and (caster, face) pairs actually drawn (6 per caster unculled)
+    std::uint32_t cameraTested = 0;
+    std::uint32_t cameraCulled = 0;
+    std::uint32_t shadowTested = 0;
+    std::uint32_t shadowCulled = 0;
+    std::uint32_t shadowFaces = 0;
+    std::uint32_t shadowFacesRestored = 0; // cached shadows: faces copied back from the static cube
+
+    // Items drawn below LOD 0 in the lit pass / casters added below LOD 0
+    std::uint32_t cameraLodReduced = 0;
+    std::uint32_t shadowLodReduced = 0;
+
+    void Reset() { *this = RenderStats{}; }
+};
+
+RenderStats& GetRenderStats();
@@ -1,10 +1,28 @@
 #include <string>
 #include "ShaderProgram.h"
+#include "Profiler.h"
+#include "ProgramCache.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include <filesystem>
 #include <iostream>
 #include <utility>
 
 std::string LoadTextFile(const std::string& path);
-GLuint CreateProgram(const char* vsSource, const char* fsSource);
+GLuint StartProgram(const char* vsSource, const char* fsSource, const char* gsSource);
+GLuint StartComputeProgram(const char* csSource);
+GLuint FinishProgram(GLuint program);
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+static bool HasParallelCompile()
+{
+	static bool has = HasGLExtension("GL_KHR_parallel_shader_compile") ||
+		HasGLExtension("GL_ARB_parallel_shader_compile");
+	return has;
+}
 
 ShaderProgram::ShaderProgram(std::string vertexPath, std::string fragmentPath)
 	:	m_vertexPath(std::move(vertexPath)),
@@ -13,37 +31,194 @@ ShaderProgram::ShaderProgram(std::string vertexPath, std::string fragmentPath)
 	Reload(); // if it fails, m_id will remain 0
 }
 
+ShaderProgram::ShaderProgram(std::string vertexPath, std::string geometryPath, std::string fragmentPath)
+	:	m_vertexPath(std::move(vertexPath)),
+		m_geometryPath(std::move(geometryPath)),
+		m_fragmentPath(std::move(fragmentPath))
+{
+	Reload();
+}
+
+ShaderProgram::ShaderProgram(std::string vertexPath, std::string fragmentPath, std::vector<std::string> defines)
+	:	m_vertexPath(std::move(vertexPath)),
+		m_fragmentPath(std::move(fragmentPath)),
+		m_defines(std::move(defines))
+{
+	Reload();
+}
+
+ShaderProgram::ShaderProgram(std::string computePath)
+	:	m_computePath(std::move(computePath))
+{
+	Reload();
+}
+
+// Inserts the defines after the #version line; #line keeps compiler messages
+// pointing at the right line of the file
+static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+	if (defines.empty() || source.empty())
+		return source;
+
+	std::size_t versionPos = source.find("#version");
+	std::size_t insertAt = (versionPos == std::string::npos) ? 0 : source.find('\n', versionPos);
+	if (insertAt == std::string::npos)
+		return source;
+	if (versionPos != std::string::npos)
+		insertAt++;
+
+	int nextLine = 1;
+	for (std::size_t i = 0; i < insertAt; i++)
+		if (source[i] == '\n') nextLine++;
+
+	std::string block;
+	for (const std::string& d : defines)
+		block += "#define " + d + "\n";
+	block += "#line " + std::to_string(nextLine) + "\n";
+
+	return source.substr(0, insertAt) + block + source.substr(insertAt);
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
+	:	m_id(std::exchange(other.m_id, 0)),
+		m_vertexPath(std::move(other.m_vertexPath)),
+		m_geometryPath(std::move(other.m_geometryPath)),
+		m_fragmentPath(std::move(other.m_fragmentPath)),
+		m_computePath(std::move(other.m_computePath)),
+		m_defines(std::move(other.m_defines)),
+		m_pendingId(std::exchange(other.m_pendingId, 0)),
+		m_pendingKey(other.m_pendingKey),
+		m_pendingFromCache(other.m_pendingFromCache)
+{
+}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept
+{
+	if (this == &other) return *this;
+	Destroy();
+	m_id = std::exchange(other.m_id, 0);
+	m_vertexPath = std::move(other.m_vertexPath);
+	m_geometryPath = std::move(other.m_geometryPath);
+	m_fragmentPath = std::move(other.m_fragmentPath);
+	m_computePath = std::move(other.m_computePath);
+	m_defines = std::move(other.m_defines);
+	if (m_pendingId != 0) glDeleteProgram(m_pendingId);
+	m_pendingId = std::exchange(other.m_pendingId, 0);
+	m_pendingKey = other.m_pendingKey;
+	m_pendingFromCache = other.m_pendingFromCache;
+	return *this;
+}
+
 bool ShaderProgram::Reload()
 {
-	std::string vs = LoadTextFile(m_vertexPath);
-	std::string fs = LoadTextFile(m_fragmentPath);
+	PROFILE_SCOPE("ShaderProgram::Reload");
+
+	return BeginReload() && FinishReload(true);
+}
 
-	if (vs.empty() || fs.empty())
+bool ShaderProgram::BeginReload()
+{
+	if (!m_computePath.empty())
+	{
+		std::string cs = InjectDefines(LoadTextFile(m_computePath), m_defines);
+		if (cs.empty())
+		{
+			std::cerr << "[Reload] Shader file was empty or missing.\n";
+			return false;
+		}
+
+		if (m_pendingId != 0)
+			glDeleteProgram(m_pendingId);
+
+		// the stage slots of the key stay empty: no graphics program can collide with it
+		ProgramCache& cache = ProgramCache::Get();
+		m_pendingKey = cache.Key(cs, {}, {});
+		m_pendingId = cache.Load(m_pendingKey);
+		m_pendingFromCache = m_pendingId != 0;
+
+		if (!m_pendingFromCache)
+			m_pendingId = StartComputeProgram(cs.c_str());
+
+		return m_pendingId != 0;
+	}
+
+	std::string vs = InjectDefines(LoadTextFile(m_vertexPath), m_defines);
+	std::string fs = InjectDefines(LoadTextFile(m_fragmentPath), m_defines);
+	std::string gs = m_geometryPath.empty() ? std::string() : InjectDefines(LoadTextFile(m_geometryPath), m_defines);
+
+	if (vs.empty() || fs.empty() || (!m_geometryPath.empty() && gs.empty()))
 	{
 		std::cerr << "[Reload] Shader file was empty or missing.\n";
 		return false;
 	}
 
-	GLuint newProgram = CreateProgram(vs.c_str(), fs.c_str());
+	// a newer edit supersedes a compile still in flight
+	if (m_pendingId != 0)
+		glDeleteProgram(m_pendingId);
+
+	// Same sources + driver as a previous run: skip compile and link entirely
+	ProgramCache& cache = ProgramCache::Get();
+	m_pendingKey = cache.Key(vs, gs, fs);
+	m_pendingId = cache.Load(m_pendingKey);
+	m_pendingFromCache = m_pendingId != 0;
+
+	if (!m_pendingFromCache)
+		m_pendingId = StartProgram(vs.c_str(), fs.c_str(), gs.empty() ? nullptr : gs.c_str());
+
+	return m_pendingId != 0;
+}
+
+bool ShaderProgram::PollReload()
+{
+	return FinishReload(false);
+}
+
+bool ShaderProgram::FinishReload(bool wait)
+{
+	if (m_pendingId == 0)
+		return false;
+
+	if (!wait && !m_pendingFromCache && HasParallelCompile())
+	{
+		GLint done = GL_FALSE;
+		glGetProgramiv(m_pendingId, GL_COMPLETION_STATUS_KHR, &done);
+		if (!done)
+			return false;
+	}
+
+	GLuint newProgram = m_pendingFromCache ? m_pendingId : FinishProgram(m_pendingId);
+	m_pendingId = 0;
 
 	if (newProgram == 0)
 	{
 		std::cerr << "[Reload] Compile/link failed. Keeping previous shader.\n";
 		return false;
 	}
+	if (!m_pendingFromCache)
+		ProgramCache::Get().Store(m_pendingKey, newProgram);
 
 	// success: replace the program
 	Destroy();
 	m_id = newProgram;
 	
-	std::cout << "[Reload] Shaders reloaded successfully.\n";
+	std::cout << "[Reload] Shaders reloaded successfully" << (m_pendingFromCache ? " (cached binary).\n" : ".\n");
 	return true;
 }
 
+bool ShaderProgram::UsesFile(const std::string& path) const
+{
+	auto Same = [&](const std::string& stagePath)
+		{
+			return !stagePath.empty() &&
+				std::filesystem::path(stagePath).lexically_normal() == std::filesystem::path(path).lexically_normal();
+		};
+	return Same(m_vertexPath) || Same(m_fragmentPath) || Same(m_geometryPath) || Same(m_computePath);
+}
+
 void ShaderProgram::Use() const
 {
 	if (m_id != 0)
-		glUseProgram(m_id);
+		GLState::Get().UseProgram(m_id);
 }
 
 void ShaderProgram::Destroy()
@@ -51,6 +226,7 @@ void ShaderProgram::Destroy()
 	if (m_id != 0)
 	{
 		glDeleteProgram(m_id);
+		GLState::Get().OnDeleteProgram(m_id);
 		m_id = 0;
 	}
 }
@@ -58,4 +234,6 @@ void ShaderProgram::Destroy()
 ShaderProgram::~ShaderProgram()
 {
 	Destroy();
+	if (m_pendingId != 0)
+		glDeleteProgram(m_pendingId);
 }
\ No newline at end of file
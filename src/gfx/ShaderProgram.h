@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 
 class ShaderProgram
@@ -11,6 +13,15 @@ public:
     // Construct from shader paths
     ShaderProgram(std::string vertexPath, std::string fragmentPath);
 
+    // Same, with a geometry stage in between
+    ShaderProgram(std::string vertexPath, std::string geometryPath, std::string fragmentPath);
+
+    // Compile-time variant: each name becomes "#define NAME" right after #version
+    ShaderProgram(std::string vertexPath, std::string fragmentPath, std::vector<std::string> defines);
+
+    // Compute program from a single .comp file
+    explicit ShaderProgram(std::string computePath);
+
     // RAII: destructor releases GPU program
     ~ShaderProgram();
 
@@ -28,12 +39,33 @@ public:
     // Returns true if new program successfully replaced the old one.
     bool Reload();
 
+    // Non-blocking reload: starts the compile (on driver threads with
+    // GL_KHR_parallel_shader_compile) and keeps using the current program until
+    // PollReload() finds it done. False if the sources couldn't be read.
+    bool BeginReload();
+    // Call once per frame (frame boundary); true on the frame the new program was swapped in
+    bool PollReload();
+    bool IsReloading() const { return m_pendingId != 0; }
+
+    // True if path is one of this program's stage files
+    bool UsesFile(const std::string& path) const;
+
     GLuint Id() const { return m_id; }
+    const std::vector<std::string>& Defines() const { return m_defines; }
 
 private:
     void Destroy(); // helper: deletes m_id if valid and sets to 0
+    bool FinishReload(bool wait);
 
     GLuint m_id = 0;
     std::string m_vertexPath;
+    std::string m_geometryPath; // empty = no geometry shader
     std::string m_fragmentPath;
+    std::string m_computePath;  // set = compute program, no other stages
+    std::vector<std::string> m_defines;
+
+    // in-flight reload (BeginReload)
+    GLuint m_pendingId = 0;
+    std::uint64_t m_pendingKey = 0;
+    bool m_pendingFromCache = false;
 };
@@ -0,0 +1,102 @@
+#include "StreamBuffer.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <algorithm>
+
+static std::uint64_t s_frame = 1;
+
+static std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+StreamBuffer::StreamBuffer(GLenum target, std::size_t regionBytes)
+    : m_buffer(target)
+{
+    Reallocate(AlignUp(std::max<std::size_t>(regionBytes, 1), REGION_ALIGNMENT));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    // the buffer is unmapped when it is deleted
+    DeleteFences();
+}
+
+void StreamBuffer::NextFrame()
+{
+    s_frame++;
+}
+
+StreamAllocation StreamBuffer::Allocate(std::size_t sizeBytes, std::size_t alignment)
+{
+    if (m_frame != s_frame)
+        Advance();
+
+    std::size_t offset = AlignUp(m_used, alignment);
+    if (offset + sizeBytes > m_regionBytes)
+    {
+        Reallocate(std::max(m_regionBytes * 2, AlignUp(sizeBytes, REGION_ALIGNMENT)));
+        offset = 0;
+    }
+    if (m_mapped == nullptr)
+        return {};
+
+    m_used = offset + sizeBytes;
+    GetRenderStats().streamBytes += sizeBytes;
+
+    const std::size_t position = m_region * m_regionBytes + offset;
+    return { m_mapped + position, position };
+}
+
+void StreamBuffer::Advance()
+{
+    m_frame = s_frame;
+    if (m_used == 0)
+        return; // nothing written last time: the region is still free
+
+    // everything reading the region has been submitted by now
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_region = (m_region + 1) % REGIONS;
+    m_used = 0;
+
+    GLsync fence = m_fences[m_region];
+    if (fence == nullptr)
+        return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        // the GPU is REGIONS frames behind
+        PROFILE_SCOPE("StreamBuffer::Wait");
+        GetRenderStats().streamWaits++;
+        do
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        while (result == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    m_fences[m_region] = nullptr;
+}
+
+void StreamBuffer::Reallocate(std::size_t regionBytes)
+{
+    // commands still reading the old buffer keep it alive; its fences no longer matter
+    DeleteFences();
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    m_regionBytes = regionBytes;
+    m_buffer.SetStorage(nullptr, REGIONS * regionBytes, flags);
+    m_mapped = static_cast<unsigned char*>(
+        glMapNamedBufferRange(m_buffer.Id(), 0, static_cast<GLsizeiptr>(REGIONS * regionBytes), flags));
+    m_region = 0;
+    m_used = 0;
+}
+
+void StreamBuffer::DeleteFences()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
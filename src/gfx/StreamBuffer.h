@@ -0,0 +1,61 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include "Buffer.h"
+
+// Where an allocation landed: write through data, point GL at offset in the buffer
+struct StreamAllocation
+{
+    unsigned char* data = nullptr;
+    std::size_t offset = 0;
+};
+
+// Ring for data rewritten every frame (instances, dynamic geometry): immutable storage
+// mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, split into REGIONS
+// per-frame regions. The CPU writes straight into the region of the current frame
+// while the GPU still reads the previous ones: no glBufferData orphaning, no implicit
+// sync. A region gets a glFenceSync when the ring moves past it and is waited on
+// before it is handed out again (counted in RenderStats::streamWaits when that blocks).
+// Allocations stay valid until the next allocation from this ring in a later frame.
+class StreamBuffer
+{
+public:
+    static constexpr int REGIONS = 3;
+
+    // target: only for Bind(); regionBytes grows on demand
+    explicit StreamBuffer(GLenum target, std::size_t regionBytes = 64 * 1024);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Space in the current frame's region (alignment divides 256). A region that is too
+    // small swaps in a bigger buffer (new Id(): commands already issued keep the old one).
+    StreamAllocation Allocate(std::size_t sizeBytes, std::size_t alignment = 4);
+
+    // Once per frame, before anything is allocated: every ring moves on to its next
+    // region with its first allocation after this
+    static void NextFrame();
+
+    void Bind() const { m_buffer.Bind(); }
+    GLuint Id() const { return m_buffer.Id(); }
+    const Buffer& GetBuffer() const { return m_buffer; }
+    std::size_t RegionBytes() const { return m_regionBytes; }
+
+private:
+    static constexpr std::size_t REGION_ALIGNMENT = 256;
+
+    // Fences the region in use and waits until the next one is free
+    void Advance();
+    void Reallocate(std::size_t regionBytes);
+    void DeleteFences();
+
+    Buffer m_buffer;
+    unsigned char* m_mapped = nullptr;
+    std::size_t m_regionBytes = 0;
+    GLsync m_fences[REGIONS] = {};
+    int m_region = 0;
+    std::size_t m_used = 0;       // bytes of the current region handed out
+    std::uint64_t m_frame = 0;    // frame the current region belongs to
+};
@@ -1,5 +1,10 @@
 #include "Texture2D.h"
-#include <stb_image.h>
+#include "CookedTexture.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "RenderStats.h"
+#include "Profiler.h"
+#include <algorithm>
 #include <iostream>
 #include <utility> // std::exchange
 
@@ -18,12 +23,16 @@ void Texture2D::Destroy()
     if (m_id != 0)
     {
         glDeleteTextures(1, &m_id);
+        GLState::Get().OnDeleteTexture(m_id);
         m_id = 0;
     }
 }
 
 Texture2D::Texture2D(Texture2D&& other) noexcept
-    : m_id(std::exchange(other.m_id, 0))
+    : m_id(std::exchange(other.m_id, 0)),
+    m_minFilter(other.m_minFilter),
+    m_magFilter(other.m_magFilter),
+    m_anisotropy(other.m_anisotropy)
 {
 }
 
@@ -32,94 +41,146 @@ Texture2D& Texture2D::operator=(Texture2D&& other) noexcept
     if (this == &other) return *this;
     Destroy();
     m_id = std::exchange(other.m_id, 0);
+    m_minFilter = other.m_minFilter;
+    m_magFilter = other.m_magFilter;
+    m_anisotropy = other.m_anisotropy;
     return *this;
 }
 
 void Texture2D::Bind(GLuint slot) const
 {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    GLState::Get().BindTexture(slot, GL_TEXTURE_2D, m_id);
 }
 
 void Texture2D::SetFiltering(GLint minFilter, GLint magFilter) const
 {
-    glBindTexture(GL_TEXTURE_2D, m_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
-}
+    if (minFilter == m_minFilter && magFilter == m_magFilter)
+    {
+        GetRenderStats().stateCallsElided += 2;
+        return;
+    }
 
-void Texture2D::SetAnisotropy(float level) const
-{
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, magFilter);
+    GetRenderStats().stateCallsIssued += 2;
+    m_minFilter = minFilter;
+    m_magFilter = magFilter;
+}
 
-    // Extension constant (commonly available)
+// Extension constant (commonly available)
 #ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
 #define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
-#endif
-#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
-#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
 #endif
 
-    float maxA = 1.0f;
-    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxA);
-
-    if (level < 1.0f) level = 1.0f;
-    if (level > maxA) level = maxA;
+void Texture2D::SetAnisotropy(float level) const
+{
+    level = std::clamp(level, 1.0f, std::max(1.0f, MaxTextureAnisotropy()));
+    if (level == m_anisotropy)
+    {
+        GetRenderStats().stateCallsElided++;
+        return;
+    }
 
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, level);
+    glTextureParameterf(m_id, GL_TEXTURE_MAX_ANISOTROPY_EXT, level);
+    GetRenderStats().stateCallsIssued++;
+    m_anisotropy = level;
 }
 
 bool Texture2D::LoadFromFile(const std::string& path)
 {
-    // Destroy old texture if reloading
-    Destroy();
+    PROFILE_SCOPE("Texture2D::LoadFromFile");
 
-    // Most images have (0,0) at top-left; OpenGL UV origin is bottom-left.
-    // Flipping is usually what you want for typical PNGs.
-    stbi_set_flip_vertically_on_load(1);
+    ImageData image;
+    if (!DecodeImage(path, image))
+        return false;
+    return Upload(image);
+}
 
-    int w = 0, h = 0, channels = 0;
-    unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 0);
-    if (!data)
-    {
-        std::cerr << "Failed to load texture: " << path << "\n";
+bool Texture2D::Upload(const ImageData& image)
+{
+    if (!Allocate(image))
         return false;
-    }
 
-    GLenum internalFormat = GL_RGBA8;
-    GLenum dataFormat = GL_RGBA;
+    for (int level = 0; level < image.LevelCount(); level++)
+        UploadRows(image, level, 0, image.RowCount(level), image.LevelData(level));
+    if (!image.IsCompressed())
+        GenerateMipmaps();
 
-    if (channels == 3)
-    {
-        internalFormat = GL_RGB8;
-        dataFormat = GL_RGB;
-    }
-    else if (channels == 4)
+    return true;
+}
+
+void Texture2D::SetDefaultSampling(bool mipmapped) const
+{
+    // Sampling & wrapping defaults (fine for now)
+    glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    m_minFilter = mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    m_magFilter = GL_LINEAR;
+    m_anisotropy = 1.0f;
+}
+
+bool Texture2D::Allocate(const ImageData& image, bool mipmaps)
+{
+    if (image.width <= 0 || image.height <= 0)
+        return false;
+
+    if (image.IsCompressed())
     {
-        internalFormat = GL_RGBA8;
-        dataFormat = GL_RGBA;
+        if (!IsCompressedFormatSupported(image.format))
+        {
+            std::cerr << CompressedFormatName(image.format) << " textures are not supported by this driver.\n";
+            return false;
+        }
+        return Allocate(image.width, image.height, mipmaps ? image.LevelCount() : 1, image.format);
     }
-    else
-    {
-        std::cerr << "Unsupported texture channel count (" << channels
-            << ") for: " << path << "\n";
-        stbi_image_free(data);
+
+    if (image.pixels.empty() || (image.channels != 3 && image.channels != 4))
         return false;
-    }
 
-    glGenTextures(1, &m_id);
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    int levels = 1;
+    for (int size = std::max(image.width, image.height); mipmaps && size > 1; size /= 2)
+        levels++;
+    return Allocate(image.width, image.height, levels, image.channels == 3 ? GL_RGB8 : GL_RGBA8);
+}
 
-    // Sampling & wrapping defaults (fine for now)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+bool Texture2D::Allocate(int width, int height, int levels, GLenum internalFormat)
+{
+    if (width <= 0 || height <= 0 || levels <= 0)
+        return false;
 
-    // Upload
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Destroy old texture if reloading
+    Destroy();
 
-    stbi_image_free(data);
+    // DSA: a streamed texture is created and filled without touching any texture unit
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+    glTextureStorage2D(m_id, levels, internalFormat, width, height);
+    SetDefaultSampling(levels > 1);
     return true;
 }
+
+void Texture2D::UploadRows(const ImageData& image, int level, int row, int rows, const void* data) const
+{
+    if (image.IsCompressed())
+    {
+        // block rows -> pixel rows; the last block row may be partly outside the level
+        const ImageLevel& l = image.levels[level];
+        int y = row * 4;
+        int height = std::min(rows * 4, l.height - y);
+        glCompressedTextureSubImage2D(m_id, level, 0, y, l.width, height, image.format,
+            static_cast<GLsizei>(rows * image.RowBytes(level)), data);
+        return;
+    }
+
+    // RGB rows aren't 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(m_id, 0, 0, row, image.width, rows,
+        image.channels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Texture2D::GenerateMipmaps() const
+{
+    glGenerateTextureMipmap(m_id);
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <glad/glad.h>
 #include <string>
+#include "ImageData.h"
 
 class Texture2D
 {
@@ -17,6 +18,21 @@ public:
 
     bool LoadFromFile(const std::string& path);
 
+    // LoadFromFile split in two: DecodeImage (ImageData.h, safe on any thread), then
+    // Upload replaces the texture on the GL thread
+    bool Upload(const ImageData& image);
+
+    // Piecewise upload (streaming): Allocate makes a new immutable texture for image
+    // (full mip chain, or level 0 only), UploadRows fills rows [row, row + rows) of one
+    // level from data (a client pointer, or an offset when a GL_PIXEL_UNPACK_BUFFER is
+    // bound). Raw images then need GenerateMipmaps; cooked ones upload every level instead.
+    bool Allocate(const ImageData& image, bool mipmaps = true);
+    bool Allocate(int width, int height, int levels, GLenum internalFormat);
+    void UploadRows(const ImageData& image, int level, int row, int rows, const void* data) const;
+    void GenerateMipmaps() const;
+
+    // Binds go through GLState; the setters skip values the texture already has.
+    // Nothing but Bind touches a texture unit (DSA).
     void Bind(GLuint slot = 0) const;
     void SetFiltering(GLint minFilter, GLint magFilter) const;
     void SetAnisotropy(float level) const;
@@ -24,7 +40,13 @@ public:
 
 private:
     void Destroy();
+    void SetDefaultSampling(bool mipmapped) const;
+
     GLuint m_id = 0;
+    // sampling state as last set (reset by Allocate)
+    mutable GLint m_minFilter = 0;
+    mutable GLint m_magFilter = 0;
+    mutable float m_anisotropy = 1.0f;
 };
 
 
@@ -0,0 +1,588 @@
+#include "TextureManager.h"
+#include "CookedTexture.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+namespace
+{
+    // Referenced textures don't drop mips below this (largest side)
+    constexpr int MIN_DROP_SIZE = 32;
+
+    std::string CanonicalPath(const std::string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            canonical = std::filesystem::absolute(path, ec).lexically_normal();
+        return canonical.string();
+    }
+
+    int FullMipCount(int width, int height)
+    {
+        int levels = 1;
+        for (int size = std::max(width, height); size > 1; size /= 2)
+            levels++;
+        return levels;
+    }
+
+    // Every level, as allocated (RGB8 counted as 3 bytes even if the driver pads it)
+    std::size_t StorageBytes(int width, int height, int levels, GLenum internalFormat)
+    {
+        unsigned blockBytes = CompressedBlockBytes(internalFormat);
+        std::size_t total = 0;
+        for (int level = 0; level < levels; level++)
+        {
+            if (blockBytes != 0)
+                total += static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+            else
+                total += static_cast<std::size_t>(width) * height * (internalFormat == GL_RGB8 ? 3 : 4);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return total;
+    }
+
+    // Worker side of TextureSettings
+    void ApplySettings(ImageData& image, const TextureSettings& settings)
+    {
+        if (settings.maxSize > 0)
+        {
+            if (image.IsCompressed())
+            {
+                // cooked mips are already there, just skip the big ones
+                std::size_t skip = 0;
+                while (skip + 1 < image.levels.size()
+                    && (image.levels[skip].width > settings.maxSize || image.levels[skip].height > settings.maxSize))
+                    skip++;
+                image.levels.erase(image.levels.begin(), image.levels.begin() + skip);
+                image.width = image.levels[0].width;
+                image.height = image.levels[0].height;
+            }
+            else
+            {
+                while ((image.width > settings.maxSize || image.height > settings.maxSize) && (image.width > 1 || image.height > 1))
+                    image = image.HalfSize();
+            }
+        }
+
+        if (!settings.mipmaps && image.IsCompressed())
+            image.levels.resize(1);
+    }
+}
+
+TextureManager::TextureManager(std::size_t uploadBudgetBytes, unsigned workers)
+    : m_uploadBudget(uploadBudgetBytes)
+{
+    ImageData grey;
+    grey.width = 1;
+    grey.height = 1;
+    grey.channels = 4;
+    grey.pixels = { 128, 128, 128, 255 };
+    m_placeholder.Upload(grey);
+
+    if (workers == 0)
+    {
+        unsigned cores = std::thread::hardware_concurrency();
+        workers = cores > 1 ? std::min(cores - 1, 4u) : 1u;
+    }
+    for (unsigned i = 0; i < workers; i++)
+        m_workers.emplace_back(&TextureManager::WorkerMain, this);
+}
+
+TextureManager::~TextureManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_queued.clear();
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers)
+        t.join();
+}
+
+TextureManager::Slot* TextureManager::Find(TextureHandle handle)
+{
+    if (handle == 0 || handle > m_slots.size())
+        return nullptr;
+    return &m_slots[handle - 1];
+}
+
+const TextureManager::Slot* TextureManager::Find(TextureHandle handle) const
+{
+    if (handle == 0 || handle > m_slots.size())
+        return nullptr;
+    return &m_slots[handle - 1];
+}
+
+TextureHandle TextureManager::Acquire(const std::string& path, const TextureSettings& settings)
+{
+    std::string canonical = CanonicalPath(path);
+    std::string key = canonical + "|" + std::to_string(settings.maxSize) + (settings.mipmaps ? "|mips" : "|nomips");
+
+    auto it = m_byKey.find(key);
+    if (it != m_byKey.end())
+    {
+        Slot& slot = *Find(it->second);
+        slot.refs++;
+        slot.lastUsed = m_frame;
+        m_dedupHits++;
+
+        // evicted (or failed) earlier: load it again
+        if (!slot.resident && !slot.loading)
+            Queue(it->second);
+        return it->second;
+    }
+
+    Slot slot;
+    slot.path = canonical;
+    slot.settings = settings;
+    slot.refs = 1;
+    slot.lastUsed = m_frame;
+    m_slots.push_back(std::move(slot));
+
+    TextureHandle handle = static_cast<TextureHandle>(m_slots.size());
+    m_byKey.emplace(std::move(key), handle);
+    Queue(handle);
+    return handle;
+}
+
+void TextureManager::Release(TextureHandle handle)
+{
+    Slot* slot = Find(handle);
+    if (slot && slot->refs > 0)
+        slot->refs--;
+}
+
+void TextureManager::Reload(TextureHandle handle)
+{
+    if (Find(handle))
+        Queue(handle);
+}
+
+bool TextureManager::ReloadPath(const std::string& path)
+{
+    const std::string canonical = CanonicalPath(path);
+
+    bool any = false;
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        const Slot& slot = m_slots[i];
+        if (slot.path != canonical)
+            continue;
+
+        // evicted and unreferenced: nothing to refresh
+        if (slot.resident || slot.loading || slot.refs > 0)
+            Queue(static_cast<TextureHandle>(i + 1));
+        any = true;
+    }
+    return any;
+}
+
+void TextureManager::Queue(TextureHandle handle)
+{
+    Slot& slot = *Find(handle);
+    slot.generation++;
+    slot.loading = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // saving twice in a row only needs one decode
+        auto it = std::find_if(m_queued.begin(), m_queued.end(),
+            [&](const Job& j) { return j.handle == handle; });
+        if (it != m_queued.end())
+        {
+            it->generation = slot.generation;
+            return;
+        }
+
+        Job job;
+        job.handle = handle;
+        job.generation = slot.generation;
+        job.path = slot.path;
+        job.settings = slot.settings;
+        m_queued.push_back(std::move(job));
+        m_inFlight++;
+    }
+    m_wake.notify_one();
+}
+
+bool TextureManager::IsResident(TextureHandle handle) const
+{
+    const Slot* slot = Find(handle);
+    return slot && slot->resident;
+}
+
+const Texture2D& TextureManager::Get(TextureHandle handle) const
+{
+    const Slot* slot = Find(handle);
+    return slot && slot->resident ? slot->texture : m_placeholder;
+}
+
+void TextureManager::Bind(TextureHandle handle, GLuint slot)
+{
+    if (Slot* s = Find(handle))
+        s->lastUsed = m_frame;
+    Get(handle).Bind(slot);
+}
+
+void TextureManager::SetFiltering(TextureHandle handle, GLint minFilter, GLint magFilter)
+{
+    Slot* slot = Find(handle);
+    if (!slot)
+        return;
+    slot->minFilter = minFilter;
+    slot->magFilter = magFilter;
+    if (slot->resident)
+        ApplySampling(*slot);
+}
+
+void TextureManager::SetAnisotropy(TextureHandle handle, float level)
+{
+    Slot* slot = Find(handle);
+    if (!slot)
+        return;
+    slot->anisotropy = level;
+    if (slot->resident)
+        ApplySampling(*slot);
+}
+
+void TextureManager::ApplySampling(Slot& slot)
+{
+    if (slot.texture.Id() == 0)
+        return;
+    // Texture2D skips whatever the new texture already has
+    if (slot.minFilter != 0 && slot.magFilter != 0)
+        slot.texture.SetFiltering(slot.minFilter, slot.magFilter);
+    slot.texture.SetAnisotropy(slot.anisotropy);
+}
+
+int TextureManager::Poll()
+{
+    PROFILE_SCOPE("TextureManager::Poll");
+
+    m_frame++;
+    int completed = Pump(m_uploadBudget);
+    EnforceBudget();
+    RestoreMips();
+    return completed;
+}
+
+void TextureManager::Finish()
+{
+    for (;;)
+    {
+        Pump(SIZE_MAX);
+        if (!m_uploads.empty())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_inFlight == 0)
+            break;
+        m_decoded.wait(lock, [&] { return !m_done.empty(); });
+    }
+    EnforceBudget();
+}
+
+int TextureManager::Pump(std::size_t budget)
+{
+    std::vector<Job> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_done);
+        m_inFlight -= static_cast<int>(done.size());
+    }
+
+    for (Job& job : done)
+    {
+        Slot& slot = *Find(job.handle);
+        if (slot.generation != job.generation)
+            continue;
+        if (!job.ok)
+        {
+            slot.loading = false;
+            continue;
+        }
+
+        Upload upload;
+        upload.job = std::move(job);
+        m_uploads.push_back(std::move(upload));
+    }
+
+    int completed = 0;
+    std::size_t spent = 0;
+    while (!m_uploads.empty())
+    {
+        Upload& upload = m_uploads.front();
+        Slot& slot = *Find(upload.job.handle);
+        const ImageData& image = upload.job.image;
+
+        // reloaded again (or evicted) while this one was in flight
+        if (slot.generation != upload.job.generation)
+        {
+            m_uploads.pop_front();
+            continue;
+        }
+
+        if (upload.texture.Id() == 0 && !upload.texture.Allocate(image, slot.settings.mipmaps))
+        {
+            slot.loading = false;
+            m_uploads.pop_front();
+            continue;
+        }
+
+        // whole rows only; a row wider than the budget still goes, on its own
+        std::size_t rowBytes = image.RowBytes(upload.level);
+        std::size_t rows = (budget - spent) / rowBytes;
+        if (rows == 0)
+        {
+            if (spent > 0)
+                break;
+            rows = 1;
+        }
+        rows = std::min(rows, static_cast<std::size_t>(image.RowCount(upload.level) - upload.rowsDone));
+        spent += UploadStrip(upload, static_cast<int>(rows));
+
+        if (upload.rowsDone < image.RowCount(upload.level))
+            continue;
+        // cooked images carry their mips, one level after the other
+        upload.level++;
+        upload.rowsDone = 0;
+        if (upload.level < image.LevelCount())
+            continue;
+
+        Complete(slot, upload);
+        completed++;
+        m_uploads.pop_front();
+    }
+    return completed;
+}
+
+void TextureManager::Complete(Slot& slot, Upload& upload)
+{
+    const ImageData& image = upload.job.image;
+    if (!image.IsCompressed() && slot.settings.mipmaps)
+        upload.texture.GenerateMipmaps();
+    if (slot.resident && slot.droppedMips == 0)
+        std::cout << "[Reload] Texture reloaded: " << slot.path << "\n";
+
+    m_residentBytes -= slot.bytes;
+
+    slot.texture = std::move(upload.texture);
+    ApplySampling(slot);
+    slot.resident = true;
+    slot.loading = false;
+    slot.width = image.width;
+    slot.height = image.height;
+    if (image.IsCompressed())
+    {
+        slot.internalFormat = image.format;
+        slot.levels = image.LevelCount();
+    }
+    else
+    {
+        slot.internalFormat = image.channels == 3 ? GL_RGB8 : GL_RGBA8;
+        slot.levels = slot.settings.mipmaps ? FullMipCount(image.width, image.height) : 1;
+    }
+    slot.bytes = StorageBytes(slot.width, slot.height, slot.levels, slot.internalFormat);
+    slot.fullBytes = slot.bytes;
+    slot.droppedMips = 0;
+
+    m_residentBytes += slot.bytes;
+    m_peakBytes = std::max(m_peakBytes, m_residentBytes);
+}
+
+std::size_t TextureManager::UploadStrip(Upload& upload, int rows)
+{
+    const ImageData& image = upload.job.image;
+    std::size_t rowBytes = image.RowBytes(upload.level);
+    std::size_t bytes = rows * rowBytes;
+    const unsigned char* src = image.LevelData(upload.level) + upload.rowsDone * rowBytes;
+
+    m_pboSize = std::max(m_pboSize, bytes);
+
+    // Orphan + map: if the GPU is still reading the previous strip the driver hands
+    // out fresh storage instead of stalling on it
+    m_pbo.SetData(nullptr, m_pboSize, GL_STREAM_DRAW);
+    void* dst = glMapNamedBufferRange(m_pbo.Id(), 0, static_cast<GLsizeiptr>(bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    bool viaPbo = false;
+    if (dst)
+    {
+        std::memcpy(dst, src, bytes);
+        viaPbo = glUnmapNamedBuffer(m_pbo.Id()) == GL_TRUE;
+    }
+
+    if (viaPbo)
+    {
+        // filled through DSA: bound only for the transfer itself
+        m_pbo.Bind();
+        upload.texture.UploadRows(image, upload.level, upload.rowsDone, rows, nullptr); // offset 0 into the PBO
+        Buffer::Unbind(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        // mapping failed (or the store got lost): plain client-memory upload
+        upload.texture.UploadRows(image, upload.level, upload.rowsDone, rows, src);
+    }
+
+    upload.rowsDone += rows;
+    return bytes;
+}
+
+void TextureManager::EnforceBudget()
+{
+    if (m_memoryBudget == 0)
+        return;
+
+    while (m_residentBytes > m_memoryBudget)
+    {
+        // least recently used texture nobody holds goes first
+        Slot* victim = nullptr;
+        for (Slot& slot : m_slots)
+        {
+            if (slot.resident && slot.refs == 0 && (!victim || slot.lastUsed < victim->lastUsed))
+                victim = &slot;
+        }
+        if (victim)
+        {
+            Evict(*victim);
+            continue;
+        }
+
+        // everything left is in use: halve the least recently used one that still can
+        for (Slot& slot : m_slots)
+        {
+            if (slot.resident && slot.levels > 1 && std::max(slot.width, slot.height) > MIN_DROP_SIZE
+                && (!victim || slot.lastUsed < victim->lastUsed))
+                victim = &slot;
+        }
+        if (!victim || !DropTopMip(*victim))
+            break; // over budget with nothing left to give
+    }
+}
+
+void TextureManager::Evict(Slot& slot)
+{
+    m_residentBytes -= slot.bytes;
+
+    slot.texture = Texture2D();
+    slot.resident = false;
+    slot.loading = false;
+    slot.generation++; // drops anything still in flight
+    slot.bytes = 0;
+    slot.fullBytes = 0;
+    slot.droppedMips = 0;
+    m_evictions++;
+}
+
+bool TextureManager::DropTopMip(Slot& slot)
+{
+    if (slot.levels <= 1)
+        return false;
+
+    int width = std::max(1, slot.width / 2);
+    int height = std::max(1, slot.height / 2);
+    Texture2D smaller;
+    if (!smaller.Allocate(width, height, slot.levels - 1, slot.internalFormat))
+        return false;
+
+    // levels 1..n become 0..n-1, GPU to GPU
+    for (int level = 0; level < slot.levels - 1; level++)
+    {
+        glCopyImageSubData(slot.texture.Id(), GL_TEXTURE_2D, level + 1, 0, 0, 0,
+            smaller.Id(), GL_TEXTURE_2D, level, 0, 0, 0,
+            std::max(1, width >> level), std::max(1, height >> level), 1);
+    }
+
+    m_residentBytes -= slot.bytes;
+
+    slot.texture = std::move(smaller);
+    ApplySampling(slot);
+    slot.width = width;
+    slot.height = height;
+    slot.levels--;
+    slot.bytes = StorageBytes(width, height, slot.levels, slot.internalFormat);
+    slot.droppedMips++;
+    m_mipDrops++;
+
+    m_residentBytes += slot.bytes;
+    return true;
+}
+
+void TextureManager::RestoreMips()
+{
+    // unreferenced textures are only cached, EnforceBudget evicts them to make room
+    std::size_t reclaimable = 0;
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.resident && slot.refs == 0)
+            reclaimable += slot.bytes;
+    }
+
+    std::size_t planned = m_residentBytes;
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        Slot& slot = m_slots[i];
+        if (slot.droppedMips == 0 || slot.refs == 0 || slot.loading || slot.lastUsed + 1 < m_frame)
+            continue;
+
+        std::size_t after = planned - slot.bytes + slot.fullBytes;
+        if (m_memoryBudget != 0 && after > m_memoryBudget + reclaimable)
+            continue;
+
+        planned = after;
+        Queue(static_cast<TextureHandle>(i + 1));
+    }
+}
+
+TextureStats TextureManager::Stats() const
+{
+    TextureStats stats;
+    stats.textures = static_cast<std::uint32_t>(m_slots.size());
+    for (const Slot& slot : m_slots)
+    {
+        stats.referenced += slot.refs > 0 ? 1 : 0;
+        stats.resident += slot.resident ? 1 : 0;
+        stats.loading += slot.loading ? 1 : 0;
+    }
+    stats.residentBytes = m_residentBytes;
+    stats.peakBytes = m_peakBytes;
+    stats.budgetBytes = m_memoryBudget;
+    stats.dedupHits = m_dedupHits;
+    stats.evictions = m_evictions;
+    stats.mipDrops = m_mipDrops;
+    return stats;
+}
+
+void TextureManager::WorkerMain()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || !m_queued.empty(); });
+            if (m_stop)
+                return;
+            job = std::move(m_queued.front());
+            m_queued.pop_front();
+        }
+
+        job.ok = DecodeImage(job.path, job.image);
+        if (job.ok)
+            ApplySettings(job.image, job.settings);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.push_back(std::move(job));
+        }
+        m_decoded.notify_all();
+    }
+}
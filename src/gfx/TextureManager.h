@@ -0,0 +1,183 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Buffer.h"
+#include "Texture2D.h"
+
+// 0 = invalid
+using TextureHandle = std::uint32_t;
+
+// Import settings; part of the cache key (same file, other settings = another texture)
+struct TextureSettings
+{
+    int maxSize = 0;     // 0 = as authored; otherwise top mips are skipped until both sides fit
+    bool mipmaps = true; // false = level 0 only
+
+    bool operator==(const TextureSettings&) const = default;
+};
+
+struct TextureStats
+{
+    std::uint32_t textures = 0;   // entries (acquired at least once)
+    std::uint32_t referenced = 0; // refcount > 0
+    std::uint32_t resident = 0;
+    std::uint32_t loading = 0;
+    std::size_t residentBytes = 0; // every level, as allocated
+    std::size_t peakBytes = 0;
+    std::size_t budgetBytes = 0;   // 0 = unlimited
+    // totals since startup
+    std::uint32_t dedupHits = 0;   // Acquire() that found the texture already there
+    std::uint32_t evictions = 0;
+    std::uint32_t mipDrops = 0;
+};
+
+// Shared, streamed textures. Acquire() hands out one handle per canonical path +
+// settings and counts references; the texture streams in (worker pool decode or cooked
+// .ctex read, then PBO uploads a few rows at a time under a per-frame byte budget) and
+// reads as a grey placeholder until resident.
+// With a memory budget, Poll() keeps residentBytes under it: least recently bound
+// unreferenced textures are evicted first, then referenced ones give up their top mip
+// (copied down on the GPU) and get it back by reloading once there is room again.
+class TextureManager
+{
+public:
+    static constexpr std::size_t DEFAULT_UPLOAD_BUDGET = 4u << 20; // bytes per Poll()
+
+    // workers = 0 picks one per spare core (at most 4)
+    explicit TextureManager(std::size_t uploadBudgetBytes = DEFAULT_UPLOAD_BUDGET, unsigned workers = 0);
+    ~TextureManager(); // drops queued work, waits for the current decodes
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // Returns at once, refcount + 1
+    TextureHandle Acquire(const std::string& path, const TextureSettings& settings = {});
+    // At 0 the texture stays cached (and dedupable) until the budget wants its memory
+    void Release(TextureHandle handle);
+
+    // Decodes + uploads again (hot reload); the old texture stays in use until the
+    // new one is complete, and for good if decoding fails
+    void Reload(TextureHandle handle);
+    // Reloads every texture loaded from path. Returns false if it isn't one of ours.
+    bool ReloadPath(const std::string& path);
+
+    bool IsResident(TextureHandle handle) const;
+    // The real texture once resident, the placeholder before that (or after a failed load)
+    const Texture2D& Get(TextureHandle handle) const;
+    // Get(handle).Bind(slot), and marks the texture as used this frame (LRU)
+    void Bind(TextureHandle handle, GLuint slot = 0);
+
+    // Sampling kept per texture and applied to every texture that replaces it (first
+    // upload, reload, mip drop / restore); the placeholder is never touched
+    void SetFiltering(TextureHandle handle, GLint minFilter, GLint magFilter);
+    void SetAnisotropy(TextureHandle handle, float level);
+
+    // GL thread, once per frame: uploads, then enforces the memory budget.
+    // Returns how many textures became resident.
+    int Poll();
+    // Blocks until everything requested so far is resident (or failed), ignoring the upload budget
+    void Finish();
+
+    std::size_t UploadBudget() const { return m_uploadBudget; }
+    void SetUploadBudget(std::size_t bytes) { m_uploadBudget = bytes; }
+    std::size_t MemoryBudget() const { return m_memoryBudget; }
+    void SetMemoryBudget(std::size_t bytes) { m_memoryBudget = bytes; } // 0 = unlimited
+
+    TextureStats Stats() const;
+
+private:
+    struct Slot
+    {
+        std::string path; // canonical
+        TextureSettings settings;
+        Texture2D texture;
+        int refs = 0;
+        bool resident = false;
+        bool loading = false;          // a decode / upload is in flight
+        std::uint32_t generation = 0;  // bumped per request, stale decodes are dropped
+        std::uint64_t lastUsed = 0;    // frame of the last Acquire / Bind
+
+        // SetFiltering / SetAnisotropy; 0 filters = Texture2D's defaults
+        GLint minFilter = 0;
+        GLint magFilter = 0;
+        float anisotropy = 1.0f;
+
+        // what is on the GPU
+        int width = 0;
+        int height = 0;
+        int levels = 0;
+        GLenum internalFormat = 0;
+        std::size_t bytes = 0;
+        std::size_t fullBytes = 0; // before any mip drops
+        int droppedMips = 0;
+    };
+
+    struct Job
+    {
+        TextureHandle handle = 0;
+        std::uint32_t generation = 0;
+        std::string path;
+        TextureSettings settings;
+        ImageData image;
+        bool ok = false;
+    };
+
+    // A decoded image being copied into a fresh texture over several frames
+    struct Upload
+    {
+        Job job;
+        Texture2D texture;
+        int level = 0;
+        int rowsDone = 0; // within level
+    };
+
+    void Queue(TextureHandle handle);
+    void WorkerMain();
+    int Pump(std::size_t budget);
+    // Copies the next rows of the current level through the PBO. Returns the bytes copied.
+    std::size_t UploadStrip(Upload& upload, int rows);
+    void Complete(Slot& slot, Upload& upload);
+    // The slot's sampling choice onto its current texture
+    static void ApplySampling(Slot& slot);
+
+    void EnforceBudget();
+    void Evict(Slot& slot);
+    bool DropTopMip(Slot& slot);
+    // refcount > 0 but running with dropped mips: reload once the full size fits
+    void RestoreMips();
+
+    Slot* Find(TextureHandle handle);
+    const Slot* Find(TextureHandle handle) const;
+
+    std::vector<Slot> m_slots; // handle = index + 1, never shrinks
+    std::unordered_map<std::string, TextureHandle> m_byKey;
+    Texture2D m_placeholder;
+    Buffer m_pbo{ GL_PIXEL_UNPACK_BUFFER };
+    std::size_t m_pboSize = 0;
+    std::size_t m_uploadBudget;
+    std::size_t m_memoryBudget = 0;
+    std::deque<Upload> m_uploads; // GL thread only
+
+    std::uint64_t m_frame = 0;
+    std::size_t m_residentBytes = 0;
+    std::size_t m_peakBytes = 0;
+    std::uint32_t m_dedupHits = 0;
+    std::uint32_t m_evictions = 0;
+    std::uint32_t m_mipDrops = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;    // workers: new job / stop
+    std::condition_variable m_decoded; // Finish(): a job moved to m_done
+    std::deque<Job> m_queued;
+    std::vector<Job> m_done;
+    int m_inFlight = 0; // queued + decoding + done, not yet picked up by Poll()
+    bool m_stop = false;
+    std::vector<std::thread> m_workers;
+};
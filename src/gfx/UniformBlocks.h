@@ -0,0 +1,57 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Buffer.h"
+#include "GLState.h"
+
+// Fixed binding points, must match layout(std140, binding = N) in the shaders
+enum class UniformBinding : GLuint
+{
+    Camera = 0, // lit.*
+    Light = 1,  // lit.frag, shadow_cube.frag
+    Shadow = 2  // shadow_cube*.vert / .geom
+};
+
+// C++ mirrors of the std140 blocks: only mat4/vec4 (and padded scalars) so the
+// layout matches without any per-member offsets.
+struct CameraBlock
+{
+    glm::mat4 view{ 1.0f };
+    glm::mat4 proj{ 1.0f };
+    glm::vec4 posWS{ 0.0f }; // w unused
+};
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock must match the std140 layout");
+
+struct LightBlock
+{
+    glm::vec4 posWS{ 0.0f }; // w unused
+    glm::vec4 color{ 1.0f }; // w unused
+    float farPlane = 1.0f;   // shadow cube range, depth is stored as distance / farPlane
+    float pad[3] = {};
+};
+static_assert(sizeof(LightBlock) == 48, "LightBlock must match the std140 layout");
+
+struct ShadowBlock
+{
+    glm::mat4 faceVP[6];     // cube face view-projections, +X -X +Y -Y +Z -Z
+};
+static_assert(sizeof(ShadowBlock) == 384, "ShadowBlock must match the std140 layout");
+
+// One UBO holding a single T, bound once to its binding point and rewritten
+// with one glNamedBufferSubData per Update() (immutable storage).
+template <typename T>
+class UniformBuffer
+{
+public:
+    explicit UniformBuffer(UniformBinding binding)
+        : m_buffer(GL_UNIFORM_BUFFER)
+    {
+        m_buffer.SetStorage(nullptr, sizeof(T), GL_DYNAMIC_STORAGE_BIT);
+        GLState::Get().BindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(binding), m_buffer.Id());
+    }
+
+    void Update(const T& data) const { m_buffer.SetSubData(0, &data, sizeof(T)); }
+
+private:
+    Buffer m_buffer;
+};
@@ -1,9 +1,10 @@
 #include "VertexArray.h"
+#include "GLState.h"
 #include <utility> // std::exchange
 
 VertexArray::VertexArray()
 {
-    glGenVertexArrays(1, &m_id);
+    glCreateVertexArrays(1, &m_id);
 }
 
 VertexArray::~VertexArray()
@@ -16,38 +17,55 @@ void VertexArray::Destroy()
     if (m_id != 0)
     {
         glDeleteVertexArrays(1, &m_id);
+        GLState::Get().OnDeleteVertexArray(m_id);
         m_id = 0;
     }
 }
 
 void VertexArray::Bind() const
 {
-    glBindVertexArray(m_id);
+    GLState::Get().BindVertexArray(m_id);
 }
 
 void VertexArray::Unbind()
 {
-    glBindVertexArray(0);
+    GLState::Get().BindVertexArray(0);
 }
 
 void VertexArray::SetAttribute(
     GLuint index,
+    GLuint binding,
     GLint size,
     GLenum type,
     GLboolean normalized,
-    GLsizei strideBytes,
-    std::size_t offsetBytes
+    GLuint relativeOffsetBytes
 ) const
 {
-    glVertexAttribPointer(
-        index,
-        size,
-        type,
-        normalized,
-        strideBytes,
-        reinterpret_cast<const void*>(offsetBytes)
-    );
-    glEnableVertexAttribArray(index);
+    glVertexArrayAttribFormat(m_id, index, size, type, normalized, relativeOffsetBytes);
+    glVertexArrayAttribBinding(m_id, index, binding);
+    glEnableVertexArrayAttrib(m_id, index);
+}
+
+void VertexArray::SetAttributeI(GLuint index, GLuint binding, GLint size, GLenum type, GLuint relativeOffsetBytes) const
+{
+    glVertexArrayAttribIFormat(m_id, index, size, type, relativeOffsetBytes);
+    glVertexArrayAttribBinding(m_id, index, binding);
+    glEnableVertexArrayAttrib(m_id, index);
+}
+
+void VertexArray::SetVertexBuffer(GLuint binding, GLuint buffer, std::size_t offsetBytes, GLsizei strideBytes) const
+{
+    glVertexArrayVertexBuffer(m_id, binding, buffer, static_cast<GLintptr>(offsetBytes), strideBytes);
+}
+
+void VertexArray::SetBindingDivisor(GLuint binding, GLuint divisor) const
+{
+    glVertexArrayBindingDivisor(m_id, binding, divisor);
+}
+
+void VertexArray::SetElementBuffer(GLuint buffer) const
+{
+    glVertexArrayElementBuffer(m_id, buffer);
 }
 
 VertexArray::VertexArray(VertexArray&& other) noexcept
@@ -17,15 +17,27 @@ public:
     void Bind() const;
     static void Unbind();
 
+    // DSA: none of these need the VAO bound. Attributes read from a binding index;
+    // the buffer behind a binding can then be swapped without touching the formats.
+
+    // Float attribute (glVertexArrayAttribFormat), offset relative to the binding's
     void SetAttribute(
         GLuint index,
+        GLuint binding,
         GLint size,
         GLenum type,
         GLboolean normalized,
-        GLsizei strideBytes,
-        std::size_t offsetBytes
+        GLuint relativeOffsetBytes
     ) const;
 
+    // Integer attribute (glVertexArrayAttribIFormat), read as int/uint in the shader
+    void SetAttributeI(GLuint index, GLuint binding, GLint size, GLenum type, GLuint relativeOffsetBytes) const;
+
+    void SetVertexBuffer(GLuint binding, GLuint buffer, std::size_t offsetBytes, GLsizei strideBytes) const;
+    // 1 = advance once per instance
+    void SetBindingDivisor(GLuint binding, GLuint divisor) const;
+    void SetElementBuffer(GLuint buffer) const;
+
     GLuint Id() const { return m_id; }
 
 private:
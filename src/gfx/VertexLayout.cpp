@@ -0,0 +1,175 @@
+#include "VertexLayout.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+PackedMeshView PackedMesh::View() const
+{
+    PackedMeshView view;
+    view.layout = layout;
+    view.vertexCount = vertexCount;
+    view.indexCount = indexCount;
+    view.indexType = indexType;
+    view.positions = positions.data();
+    view.attributes = attributes.data();
+    view.indices = indices.data();
+    view.lodCount = lodCount;
+    std::copy(lods, lods + MAX_MESH_LODS, view.lods);
+    view.dequantize = dequantize;
+    view.bounds = bounds;
+    return view;
+}
+
+std::uint16_t FloatToHalf(float value)
+{
+    std::uint32_t f;
+    std::memcpy(&f, &value, 4);
+    std::uint32_t sign = (f >> 16) & 0x8000u;
+    std::uint32_t exponent = (f >> 23) & 0xFFu;
+    std::uint32_t mantissa = f & 0x7FFFFFu;
+
+    if (exponent == 0xFF) // inf / nan
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+
+    int e = static_cast<int>(exponent) - 127 + 15;
+    if (e >= 31) // overflow -> inf
+        return static_cast<std::uint16_t>(sign | 0x7C00u);
+
+    if (e <= 0) // subnormal (or zero)
+    {
+        if (e < -10)
+            return static_cast<std::uint16_t>(sign);
+        mantissa |= 0x800000u;
+        int shift = 14 - e;
+        std::uint32_t half = mantissa >> shift;
+        std::uint32_t rest = mantissa & ((1u << shift) - 1);
+        std::uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    // round to nearest even; a mantissa carry bumps the exponent, which is what we want
+    std::uint32_t half = (static_cast<std::uint32_t>(e) << 10) | (mantissa >> 13);
+    std::uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1)))
+        half++;
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+void EncodeOctahedral(const glm::vec3& normal, std::int16_t out[2])
+{
+    float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    glm::vec2 p = l1 > 0.0f ? glm::vec2(normal.x, normal.y) / l1 : glm::vec2(0.0f);
+    if (normal.z < 0.0f)
+    {
+        glm::vec2 folded((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+        p = folded;
+    }
+    out[0] = static_cast<std::int16_t>(std::lround(std::clamp(p.x, -1.0f, 1.0f) * 32767.0f));
+    out[1] = static_cast<std::int16_t>(std::lround(std::clamp(p.y, -1.0f, 1.0f) * 32767.0f));
+}
+
+glm::vec4 PackVertices(const float* vertices, std::size_t vertexCount, const VertexLayout& layout,
+    void* positions, void* attributes, AABB& bounds)
+{
+    const float* v = vertices;
+    bounds = AABB{};
+    for (std::size_t i = 0; i < vertexCount; i++)
+        bounds.Expand(glm::vec3(v[i * 8], v[i * 8 + 1], v[i * 8 + 2]));
+    if (bounds.IsEmpty())
+        bounds.min = bounds.max = glm::vec3(0.0f);
+
+    glm::vec4 dequantize(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::vec3 size = bounds.max - bounds.min;
+    float extent = std::max({ size.x, size.y, size.z });
+    if (layout.position == PositionFormat::Unorm16)
+        dequantize = glm::vec4(bounds.min, extent > 0.0f ? extent : 1.0f);
+    else if (layout.position == PositionFormat::Half3)
+        dequantize = glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f);
+
+    const glm::vec3 offset(dequantize);
+    const float invScale = 1.0f / dequantize.w;
+
+    unsigned char* pos = static_cast<unsigned char*>(positions);
+    unsigned char* attr = static_cast<unsigned char*>(attributes);
+    for (std::size_t i = 0; i < vertexCount; i++, v += 8)
+    {
+        glm::vec3 p(v[0], v[1], v[2]);
+        if (layout.position == PositionFormat::Float3)
+        {
+            std::memcpy(pos, &p, 12);
+        }
+        else
+        {
+            glm::vec3 q = (p - offset) * invScale;
+            std::uint16_t packed[4] = {};
+            for (int c = 0; c < 3; c++)
+            {
+                packed[c] = layout.position == PositionFormat::Half3 ? FloatToHalf(q[c])
+                    : static_cast<std::uint16_t>(std::lround(std::clamp(q[c], 0.0f, 1.0f) * 65535.0f));
+            }
+            std::memcpy(pos, packed, 8);
+        }
+        pos += layout.PositionStride();
+
+        std::int16_t oct[2];
+        EncodeOctahedral(glm::vec3(v[3], v[4], v[5]), oct);
+        std::memcpy(attr, oct, 4);
+        if (layout.uv == UvFormat::Float2)
+        {
+            std::memcpy(attr + 4, v + 6, 8);
+        }
+        else
+        {
+            std::uint16_t uv[2] = { FloatToHalf(v[6]), FloatToHalf(v[7]) };
+            std::memcpy(attr + 4, uv, 4);
+        }
+        attr += layout.AttributeStride();
+    }
+    return dequantize;
+}
+
+PackedMesh PackMesh(const MeshData& data, const VertexLayout& layout)
+{
+    PackedMesh mesh;
+    mesh.layout = layout;
+    mesh.vertexCount = static_cast<std::uint32_t>(data.VertexCount());
+
+    std::vector<unsigned int> allIndices(data.indices);
+    mesh.lods[0] = { 0, static_cast<std::uint32_t>(data.indices.size()), 0.0f };
+    for (const MeshLodData& lod : data.lods)
+    {
+        if (mesh.lodCount == MAX_MESH_LODS)
+            break;
+        mesh.lods[mesh.lodCount++] = { static_cast<std::uint32_t>(allIndices.size()),
+            static_cast<std::uint32_t>(lod.indices.size()), lod.error };
+        allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+    }
+    mesh.indexCount = static_cast<std::uint32_t>(allIndices.size());
+
+    mesh.positions.resize(mesh.vertexCount * layout.PositionStride());
+    mesh.attributes.resize(mesh.vertexCount * layout.AttributeStride());
+    mesh.dequantize = PackVertices(data.vertices.data(), mesh.vertexCount, layout,
+        mesh.positions.data(), mesh.attributes.data(), mesh.bounds);
+
+    if (mesh.vertexCount <= MAX_SHORT_INDEX_VERTICES)
+    {
+        mesh.indexType = GL_UNSIGNED_SHORT;
+        mesh.indices.resize(mesh.indexCount * sizeof(std::uint16_t));
+        for (std::size_t i = 0; i < mesh.indexCount; i++)
+        {
+            std::uint16_t index = static_cast<std::uint16_t>(allIndices[i]);
+            std::memcpy(mesh.indices.data() + i * 2, &index, 2);
+        }
+    }
+    else
+    {
+        mesh.indexType = GL_UNSIGNED_INT;
+        mesh.indices.resize(mesh.indexCount * sizeof(std::uint32_t));
+        std::memcpy(mesh.indices.data(), allIndices.data(), mesh.indices.size());
+    }
+    return mesh;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+struct MeshData;
+
+// How a Mesh stores its vertices on the GPU. Two streams per mesh:
+//  - positions (attribute 0), alone so depth/shadow passes fetch nothing else
+//  - normal + uv (attributes 1, 2)
+// Normals are always octahedral snorm16 (2 x 16 bit, decoded in lit.vert).
+enum class PositionFormat : std::uint32_t
+{
+    Float3,  // 12 bytes, exact
+    Half3,   // 8 bytes (padded), relative to the bounds center
+    Unorm16  // 8 bytes (padded), 0..1 over the bounds' largest side
+};
+
+enum class UvFormat : std::uint32_t
+{
+    Float2, // 8 bytes
+    Half2   // 4 bytes
+};
+
+struct VertexLayout
+{
+    PositionFormat position = PositionFormat::Unorm16;
+    UvFormat uv = UvFormat::Half2;
+
+    // As authored (32-bit floats everywhere but the normals)
+    static VertexLayout Full() { return { PositionFormat::Float3, UvFormat::Float2 }; }
+
+    std::size_t PositionStride() const { return position == PositionFormat::Float3 ? 12 : 8; }
+    std::size_t AttributeStride() const { return 4 + (uv == UvFormat::Float2 ? 8 : 4); }
+    std::size_t VertexBytes() const { return PositionStride() + AttributeStride(); }
+
+    bool operator==(const VertexLayout&) const = default;
+};
+
+// 16-bit indices when every vertex fits
+constexpr std::size_t MAX_SHORT_INDEX_VERTICES = 65536;
+
+// Levels of detail per mesh, LOD 0 (full detail) included
+constexpr int MAX_MESH_LODS = 4;
+
+// One level's slice of the index buffer; all levels share the vertices.
+// error: how far the level's surface may stray from LOD 0, object space units.
+struct MeshLodRange
+{
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+    float error = 0.0f;
+};
+static_assert(sizeof(MeshLodRange) == 12, "MeshLodRange is part of the .cmesh format");
+
+// A mesh in its GPU form; points into memory owned elsewhere (PackedMesh, a mapped .cmesh)
+struct PackedMeshView
+{
+    VertexLayout layout;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;       // all levels
+    GLenum indexType = GL_UNSIGNED_INT; // or GL_UNSIGNED_SHORT
+    const void* positions = nullptr;    // vertexCount * layout.PositionStride()
+    const void* attributes = nullptr;   // vertexCount * layout.AttributeStride()
+    const void* indices = nullptr;      // indexCount * 2 or 4
+    std::uint32_t lodCount = 0;         // 0 = a single level covering all indices
+    MeshLodRange lods[MAX_MESH_LODS];
+    // object space position = stored * w + xyz (uniform, so normals need no correction)
+    glm::vec4 dequantize{ 0.0f, 0.0f, 0.0f, 1.0f };
+    AABB bounds; // object space
+};
+
+struct PackedMesh
+{
+    VertexLayout layout;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::vector<unsigned char> positions;
+    std::vector<unsigned char> attributes;
+    std::vector<unsigned char> indices; // LOD 0, then the coarser levels
+    std::uint32_t lodCount = 1;
+    MeshLodRange lods[MAX_MESH_LODS];
+    glm::vec4 dequantize{ 0.0f, 0.0f, 0.0f, 1.0f };
+    AABB bounds;
+
+    PackedMeshView View() const;
+};
+
+// Quantizes / encodes MeshData (8 floats per vertex) into layout, LODs appended to the indices
+PackedMesh PackMesh(const MeshData& data, const VertexLayout& layout = {});
+// The vertex half of PackMesh: encodes vertexCount float vertices (8 each) into the
+// layout's position and attribute streams (vertexCount * stride bytes each, may be mapped
+// GPU memory). Returns the dequantize transform; bounds receives the float positions' box.
+glm::vec4 PackVertices(const float* vertices, std::size_t vertexCount, const VertexLayout& layout,
+    void* positions, void* attributes, AABB& bounds);
+
+std::uint16_t FloatToHalf(float value);
+// Unit vector -> octahedral snorm16 pair
+void EncodeOctahedral(const glm::vec3& normal, std::int16_t out[2]);
@@ -7,13 +7,45 @@
 #include "gfx/ShaderProgram.h"
 #include "gfx/Buffer.h"
 #include "gfx/Texture2D.h"
+#include "gfx/CookedTexture.h"
 #include "gfx/VertexArray.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <algorithm>
 #include "gfx/Primitives.h"
+#include "gfx/InstanceBatcher.h"
+#include "gfx/StreamBuffer.h"
+#include "gfx/PointShadowMap.h"
+#include "gfx/GpuScene.h"
+#include "gfx/GLState.h"
+#include "gfx/Bounds.h"
+#include "gfx/UniformBlocks.h"
+#include "gfx/ProgramCache.h"
+#include "scene/TransformStore.h"
 #include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <memory>
+#include <filesystem>
+#include <chrono>
+#include "app/Benchmark.h"
+#include "app/AssetWatcher.h"
+#include "gfx/TextureManager.h"
+#include "gfx/MeshImporter.h"
+#include "gfx/MeshOptimizer.h"
+#include "gfx/MeshSimplifier.h"
+#include "gfx/GeometryArena.h"
+#include "gfx/CookedMesh.h"
+#include "gfx/RenderStats.h"
+#include "gfx/Profiler.h"
+
+#if MINIRENDERER_HEADLESS
+#include "app/HeadlessContext.h"
+#endif
 
 static void glfwErrorCallback(int code, const char* description)
 {
@@ -25,60 +57,95 @@ static void framebufferSizeCallback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
-// Compiles a vertex or fragment shader from source
-// Returns shader ID or 0 on failure
-GLuint CompileShader(GLenum type, const char* source) 
+static const char* ShaderTypeName(GLenum type)
+{
+    return (type == GL_VERTEX_SHADER) ? "VERTEX" :
+        (type == GL_FRAGMENT_SHADER) ? "FRAGMENT" :
+        (type == GL_GEOMETRY_SHADER) ? "GEOMETRY" :
+        (type == GL_COMPUTE_SHADER) ? "COMPUTE" : "UNKNOWN";
+}
+
+// Compiles a vertex, fragment, geometry or compute shader from source without waiting
+// for the result (checked in FinishProgram)
+static GLuint StartShader(GLenum type, const char* source)
 {
     GLuint shader = glCreateShader(type);
 
     glShaderSource(shader, 1, &source, nullptr);
     glCompileShader(shader);
+    return shader;
+}
 
-    int success = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-
-    if (!success) {             
-        char infoLog[1024];
-        glGetShaderInfoLog(shader, 1024, nullptr, infoLog);
-
-        const char* shaderType =
-            (type == GL_VERTEX_SHADER) ? "VERTEX" :
-            (type == GL_FRAGMENT_SHADER) ? "FRAGMENT" : "UNKNOWN";
-
-        std::cerr << shaderType << " shader compile error:\n" << infoLog << "\n";
+// Compiles and links vertex + fragment (+ optional geometry) sources but doesn't
+// query any status, so drivers with parallel shader compile keep working on it in
+// the background (poll GL_COMPLETION_STATUS_KHR). Pass the result to FinishProgram.
+GLuint StartProgram(const char* vsSource, const char* fsSource, const char* gsSource)
+{
+    GLuint program = glCreateProgram();
+    // lets ProgramCache fetch the binary afterwards
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
+    GLuint shaders[3] = {
+        StartShader(GL_VERTEX_SHADER, vsSource),
+        StartShader(GL_FRAGMENT_SHADER, fsSource),
+        gsSource ? StartShader(GL_GEOMETRY_SHADER, gsSource) : 0
+    };
+    for (GLuint shader : shaders)
+    {
+        if (shader == 0) continue;
+        glAttachShader(program, shader);
+        // only flagged: it goes away when detached in FinishProgram
         glDeleteShader(shader);
-        return 0;
     }
 
-    return shader;
+    glLinkProgram(program);
+    return program;
 }
 
-// Links a shader program from vertex + fragment sources
-// Returns program ID or 0 on failure
-GLuint CreateProgram(const char* vsSource, const char* fsSource)
+// Same for a compute-only program
+GLuint StartComputeProgram(const char* csSource)
 {
-    GLuint vs = CompileShader(GL_VERTEX_SHADER, vsSource);
-    if (vs == 0) return 0;
+    GLuint program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fsSource);
-    if (fs == 0)
-    {
-        glDeleteShader(vs);
-        return 0;
-    }
+    GLuint shader = StartShader(GL_COMPUTE_SHADER, csSource);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
     glLinkProgram(program);
+    return program;
+}
+
+// Waits for a StartProgram/StartComputeProgram result (if still compiling) and checks it.
+// Returns program ID or 0 on failure (the program is deleted)
+GLuint FinishProgram(GLuint program)
+{
+    if (program == 0) return 0;
 
     int success = 0;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
 
-    // delete shaders after linking; program keeps what it needs
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    GLuint shaders[3] = {};
+    GLsizei shaderCount = 0;
+    glGetAttachedShaders(program, 3, &shaderCount, shaders);
+
+    for (GLsizei i = 0; i < shaderCount && !success; i++)
+    {
+        int compiled = 0;
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compiled);
+        if (compiled) continue;
+
+        GLint type = 0;
+        glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+
+        char infoLog[1024];
+        glGetShaderInfoLog(shaders[i], 1024, nullptr, infoLog);
+        std::cerr << ShaderTypeName(type) << " shader compile error:\n" << infoLog << "\n";
+    }
+
+    // detach shaders after linking; program keeps what it needs
+    for (GLsizei i = 0; i < shaderCount; i++)
+        glDetachShader(program, shaders[i]);
 
     if (!success)
     {
@@ -93,6 +160,13 @@ GLuint CreateProgram(const char* vsSource, const char* fsSource)
     return program;
 }
 
+// Links a shader program from vertex + fragment (+ optional geometry) sources
+// Returns program ID or 0 on failure
+GLuint CreateProgram(const char* vsSource, const char* fsSource, const char* gsSource)
+{
+    return FinishProgram(StartProgram(vsSource, fsSource, gsSource));
+}
+
 std::string LoadTextFile(const std::string& path)
 {
     std::ifstream file(path);
@@ -107,98 +181,215 @@ std::string LoadTextFile(const std::string& path)
     return buffer.str();
 }
 
-struct Transform
-{
-    glm::vec3 position{ 0.0f };
-    glm::vec3 rotationEuler{ 0.0f }; // radians: x,y,z
-    glm::vec3 scale{ 1.0f };
-};
-
-static glm::mat4 MakeModelMatrix(const Transform& t)
+// The TexCook / MeshCook output (.ctex / .cmesh) next to a source file wins over the file itself
+static std::string CookedOrSource(const std::string& path, const char* cookedExt = COOKED_TEXTURE_EXT)
 {
-    glm::mat4 M(1.0f);
-    M = glm::translate(M, t.position);
-    M = glm::rotate(M, t.rotationEuler.x, glm::vec3(1, 0, 0));
-    M = glm::rotate(M, t.rotationEuler.y, glm::vec3(0, 1, 0));
-    M = glm::rotate(M, t.rotationEuler.z, glm::vec3(0, 0, 1));
-    M = glm::scale(M, t.scale);
-    return M;
+    std::filesystem::path cooked = std::filesystem::path(path).replace_extension(cookedExt);
+    std::error_code ec;
+    return std::filesystem::exists(cooked, ec) ? cooked.string() : path;
 }
 
-int main()
+struct RunOptions
 {
-    glfwSetErrorCallback(glfwErrorCallback);
+    bool headless = false;   // render into an offscreen FBO, no window/input
+    int frames = 300;        // headless only: fixed number of frames to render
+    int width = 1280;
+    int height = 720;
+    std::string outPath;     // headless only: optional PPM of the last frame
 
-    if (!glfwInit())
+    bool bench = false;      // scripted camera/light, timed passes, then exit
+    BenchmarkSettings benchSettings;
+
+    std::string shadowPath;  // perface | gs | layer (default: best supported)
+    bool shadowCache = true; // static casters cached in their own cube (see PointShadowMap)
+
+    std::string tracePath;   // Chrome trace of the first traceFrames frames (incl. startup)
+    int traceFrames = 60;
+
+    std::string shaderCacheDir = "shader_cache"; // linked program binaries, empty = off
+
+    int grid = 0;            // adds a grid x grid field of small cubes (culling / stress tests)
+
+    int textureBudgetMB = 256; // texture memory the TextureManager keeps to, 0 = unlimited
+
+    std::string meshPath;    // .obj / .glb placed next to the cubes
+    bool gridMesh = false;   // the grid uses the --mesh model instead of cubes
+
+    float lodError = 1.0f;       // screen-space error (pixels) allowed in the lit pass, 0 = LOD 0 only
+    float shadowLodError = 4.0f; // same for shadow casters, in shadow cube texels
+
+    bool gpuDriven = false;  // culling + LOD in a compute shader, one multi-draw per pass (see GpuScene)
+
+    int wave = 0;            // adds a wave x wave vertex sheet deformed every frame (Mesh::UpdateVertices)
+};
+
+static bool ParseArgs(int argc, char** argv, RunOptions& opt)
+{
+    for (int i = 1; i < argc; i++)
     {
-        std::cerr << "Failed to init GLFW\n";
-        return 1;
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--headless") == 0)
+            opt.headless = true;
+        else if (std::strcmp(arg, "--frames") == 0 && hasValue)
+            opt.frames = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--size") == 0 && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2)
+                return false;
+        }
+        else if (std::strcmp(arg, "--out") == 0 && hasValue)
+            opt.outPath = argv[++i];
+        else if (std::strcmp(arg, "--bench") == 0)
+            opt.bench = true;
+        else if (std::strcmp(arg, "--warmup") == 0 && hasValue)
+            opt.benchSettings.warmupFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--measure") == 0 && hasValue)
+            opt.benchSettings.measuredFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--shadow-path") == 0 && hasValue)
+            opt.shadowPath = argv[++i];
+        else if (std::strcmp(arg, "--no-shadow-cache") == 0)
+            opt.shadowCache = false;
+        else if (std::strcmp(arg, "--shader-cache") == 0 && hasValue)
+            opt.shaderCacheDir = argv[++i];
+        else if (std::strcmp(arg, "--no-shader-cache") == 0)
+            opt.shaderCacheDir.clear();
+        else if (std::strcmp(arg, "--trace") == 0 && hasValue)
+            opt.tracePath = argv[++i];
+        else if (std::strcmp(arg, "--trace-frames") == 0 && hasValue)
+            opt.traceFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--grid") == 0 && hasValue)
+            opt.grid = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--texture-budget") == 0 && hasValue)
+            opt.textureBudgetMB = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--mesh") == 0 && hasValue)
+            opt.meshPath = argv[++i];
+        else if (std::strcmp(arg, "--grid-mesh") == 0)
+            opt.gridMesh = true;
+        else if (std::strcmp(arg, "--lod-error") == 0 && hasValue)
+            opt.lodError = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(arg, "--shadow-lod-error") == 0 && hasValue)
+            opt.shadowLodError = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(arg, "--gpu-driven") == 0)
+            opt.gpuDriven = true;
+        else if (std::strcmp(arg, "--wave") == 0 && hasValue)
+            opt.wave = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bench-out") == 0 && hasValue)
+        {
+            opt.bench = true;
+            opt.benchSettings.outPath = argv[++i];
+        }
+        else
+            return false;
     }
 
-    // Request modern OpenGL core profile
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    return opt.frames >= 0 && opt.width > 0 && opt.height > 0 && opt.grid >= 0 && opt.textureBudgetMB >= 0 && (opt.wave == 0 || opt.wave >= 2) &&
+        opt.benchSettings.warmupFrames >= 0 && opt.benchSettings.measuredFrames > 0;
+}
+
+// Explicit uniform locations in lit.frag; everything else comes from the UBOs
+static const GLint LIT_USE_TEXTURE_LOC = 0;
+static const GLint LIT_IS_LIGHT_LOC = 1;
 
-    GLFWwindow* window = glfwCreateWindow(1280, 720, "MiniRenderer", nullptr, nullptr);
-    if (!window)
+int main(int argc, char** argv)
+{
+    RunOptions opt;
+    if (!ParseArgs(argc, argv, opt))
     {
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate();
+        std::cerr << "Usage: MiniRenderer [--headless] [--frames N] [--size WxH] [--out frame.ppm]\n"
+            << "                    [--bench] [--warmup N] [--measure M] [--bench-out results.csv|.json]\n"
+            << "                    [--trace trace.json] [--trace-frames N] [--shadow-path perface|gs|layer]\n"
+            << "                    [--texture-budget MB] [--mesh model.obj|.glb] [--grid-mesh]\n"
+            << "                    [--lod-error PX] [--shadow-lod-error PX] [--gpu-driven] [--wave N]\n";
         return 1;
     }
 
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    GLFWwindow* window = nullptr;   // stays null in headless mode
+    GLuint targetFBO = 0;           // where the lit pass ends up (0 = window)
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+#if MINIRENDERER_HEADLESS
+    HeadlessContext headless;
+#endif
 
-    // Load OpenGL function pointers
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (opt.headless)
     {
-        std::cerr << "Failed to init GLAD\n";
-        glfwDestroyWindow(window);
-        glfwTerminate();
+#if MINIRENDERER_HEADLESS
+        if (!headless.Create(opt.width, opt.height))
+            return 1;
+        targetFBO = headless.Framebuffer();
+#else
+        std::cerr << "Headless mode not available in this build (MINIRENDERER_HEADLESS=OFF)\n";
         return 1;
+#endif
     }
+    else
+    {
+        glfwSetErrorCallback(glfwErrorCallback);
 
-    glEnable(GL_DEPTH_TEST);
-
+        if (!glfwInit())
+        {
+            std::cerr << "Failed to init GLFW\n";
+            return 1;
+        }
 
+        // Request modern OpenGL core profile
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    const unsigned int SHADOW_SIZE = 1024;   // try 1024 first, later 2048
-    const float SHADOW_NEAR = 0.1f;
-    const float SHADOW_FAR = 50.0f;         // must be >= your scene extents
+        window = glfwCreateWindow(opt.width, opt.height, "MiniRenderer", nullptr, nullptr);
+        if (!window)
+        {
+            std::cerr << "Failed to create GLFW window\n";
+            glfwTerminate();
+            return 1;
+        }
 
-    GLuint shadowFBO = 0;
-    GLuint shadowCube = 0;
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    glGenFramebuffers(1, &shadowFBO);
-    glGenTextures(1, &shadowCube);
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, shadowCube);
-    for (int i = 0; i < 6; i++)
-    {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0,
-            GL_DEPTH_COMPONENT24, SHADOW_SIZE, SHADOW_SIZE, 0,
-            GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        // Load OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cerr << "Failed to init GLAD\n";
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 1;
+        }
     }
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    // Created once GL is up; replaces input with a scripted path when set
+    std::unique_ptr<Benchmark> bench;
+    if (opt.bench)
+        bench = std::make_unique<Benchmark>(opt.benchSettings);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowCube, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
+    if (!opt.tracePath.empty())
+        Profiler::Get().StartCapture(opt.tracePath, opt.traceFrames);
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cerr << "Shadow cubemap FBO incomplete!\n";
+    // Tears down whichever context we made (headless cleans up in its destructor)
+    auto Shutdown = [&]()
+        {
+            Profiler::Get().Flush();
+            Profiler::Get().Shutdown();
+            GeometryArena::Get().Shutdown();
+            bench.reset();
+            if (window)
+            {
+                glfwDestroyWindow(window);
+                glfwTerminate();
+            }
+        };
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+
+
+
+    const unsigned int SHADOW_SIZE = 1024;   // try 1024 first, later 2048
+    const float SHADOW_NEAR = 0.1f;
+    const float SHADOW_FAR = 50.0f;         // must be >= your scene extents
 
 
 
@@ -211,103 +402,251 @@ int main()
     glm::vec3 camFront(0.0f, 0.0f, -1.0f);
     glm::vec3 camUp(0.0f, 1.0f, 0.0f);
 
-    float lastTime = (float)glfwGetTime();
+    // Headless and benchmark runs use a fixed timestep so every run renders the same frames
+    const float HEADLESS_DT = 1.0f / 60.0f;
+    int frameIndex = 0;
+
+    auto GetTime = [&]()
+        {
+            return (window && !bench) ? (float)glfwGetTime() : frameIndex * HEADLESS_DT;
+        };
+    auto GetFramebufferSize = [&](int& fw, int& fh)
+        {
+            if (window)
+                glfwGetFramebufferSize(window, &fw, &fh);
+            else
+            {
+                fw = opt.width;
+                fh = opt.height;
+            }
+        };
+
+    float lastTime = GetTime();
 
     int fbWidth = 0, fbHeight = 0;
-    glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+    GetFramebufferSize(fbWidth, fbHeight);
     glViewport(0, 0, fbWidth, fbHeight);
 
     std::cout << "OpenGL: " << glGetString(GL_VERSION) << "\n";
 
-    ShaderProgram program(
+    ProgramCache::Get().SetDirectory(opt.shaderCacheDir);
+
+    // Two builds of the lit shader: the general one reads the per-instance normal
+    // matrix, the UNIFORM_SCALE one just uses mat3(model) (no extra attribute fetch)
+    ShaderProgram lit(
         std::string(ASSETS_DIR) + "/shaders/lit.vert",
         std::string(ASSETS_DIR) + "/shaders/lit.frag"
     );
-    if (program.Id() == 0)
+    ShaderProgram litUniform(
+        std::string(ASSETS_DIR) + "/shaders/lit.vert",
+        std::string(ASSETS_DIR) + "/shaders/lit.frag",
+        std::vector<std::string>{ "UNIFORM_SCALE" }
+    );
+    if (lit.Id() == 0 || litUniform.Id() == 0)
     {
         std::cerr << "Failed to create shader program.\n";
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        Shutdown();
         return 1;
     }
 
+    // Per-frame data shared by lit.* and shadow_cube.* (one write each per frame);
+    // bound once to fixed binding points, so shader reloads need no lookups
+    UniformBuffer<CameraBlock> cameraUbo(UniformBinding::Camera);
+    UniformBuffer<LightBlock> lightUbo(UniformBinding::Light);
 
-    ShaderProgram shadowProg(
-        std::string(ASSETS_DIR) + "/shaders/shadow_cube.vert",
-        std::string(ASSETS_DIR) + "/shaders/shadow_cube.frag"
-    );
-    if (shadowProg.Id() == 0) 
+
+    PointShadowMap shadowMap(std::string(ASSETS_DIR) + "/shaders", SHADOW_SIZE, SHADOW_NEAR, SHADOW_FAR);
+    if (!shadowMap.IsValid())
     {
         std::cerr << "Failed to create shader program.\n";
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        Shutdown();
         return 1;
     }
 
-
-    Texture2D tex(std::string(ASSETS_DIR) + "/textures/checker.png");
-    if (tex.Id() == 0)
+    ShadowPath shadowPath = shadowMap.BestPath();
+    if (!opt.shadowPath.empty())
     {
-        std::cerr << "Failed to load texture.\n";
+        if (opt.shadowPath == "perface") shadowPath = ShadowPath::PerFace;
+        else if (opt.shadowPath == "gs") shadowPath = ShadowPath::GeometryShader;
+        else if (opt.shadowPath == "layer") shadowPath = ShadowPath::VertexLayer;
+        else std::cerr << "Unknown shadow path '" << opt.shadowPath << "', using default.\n";
     }
+    if (shadowMap.SetPath(shadowPath) != shadowPath)
+        std::cerr << "Shadow path " << PointShadowMap::PathName(shadowPath) << " not supported, falling back.\n";
+    std::cout << "[Shadow] Path: " << PointShadowMap::PathName(shadowMap.Path()) << "\n";
+    shadowMap.SetCaching(opt.shadowCache);
+
+
+    // Textures stream in: decoded on worker threads, uploaded a few MB per frame,
+    // grey placeholder until resident. Shared per path, kept under the memory budget.
+    TextureManager textures;
+    textures.SetMemoryBudget(static_cast<std::size_t>(opt.textureBudgetMB) << 20);
+    const TextureHandle tex = textures.Acquire(CookedOrSource(std::string(ASSETS_DIR) + "/textures/checker.png"));
+    if (!window || bench)
+        textures.Finish(); // scripted runs start fully resident so frames are reproducible
+
+    // Hot reload: the watcher reports saved files, textures go back through the
+    // loader and shaders compile in the background; both swap in at the top of a frame
+    std::unique_ptr<AssetWatcher> watcher;
+    if (window && !bench)
+        watcher = std::make_unique<AssetWatcher>(ASSETS_DIR);
+
+    // created once the scene exists (--gpu-driven)
+    std::unique_ptr<GpuScene> gpuScene;
+
+    // empty path = every program
+    auto BeginShaderReload = [&](const std::string& path)
+        {
+            for (ShaderProgram* p : { &lit, &litUniform })
+            {
+                if (path.empty() || p->UsesFile(path))
+                    p->BeginReload();
+            }
+            shadowMap.BeginReloadShaders(path);
+            if (gpuScene)
+                gpuScene->BeginReloadShaders(path);
+        };
 
 
     Mesh cube = CreateCube();
 
+    std::unique_ptr<Mesh> imported;
+    if (!opt.meshPath.empty())
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::string path = CookedOrSource(opt.meshPath, COOKED_MESH_EXT);
+        std::size_t vertexCount = 0, triangleCount = 0;
+
+        if (std::filesystem::path(path).extension() == COOKED_MESH_EXT)
+        {
+            // mapped, uploaded from the mapping, unmapped
+            MappedFile file;
+            CookedMesh cooked;
+            if (OpenCookedMesh(path, file, cooked) && cooked.header->indexCount > 0)
+            {
+                imported = std::make_unique<Mesh>(cooked);
+                vertexCount = cooked.header->vertexCount;
+                triangleCount = cooked.header->lods[0].indexCount / 3;
+            }
+        }
+        else
+        {
+            MeshData data;
+            if (ImportMesh(path, data) && !data.indices.empty())
+            {
+                VertexCacheStats before, after;
+                OptimizeMesh(data, &before, &after);
+                std::cout << "[Mesh] ACMR " << before.acmr << " -> " << after.acmr
+                    << ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+                GenerateLods(data);
+                imported = std::make_unique<Mesh>(data);
+                vertexCount = data.VertexCount();
+                triangleCount = data.TriangleCount();
+            }
+        }
+
+        if (imported)
+        {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "[Mesh] " << path << ": " << vertexCount << " verts, "
+                << triangleCount << " tris, " << imported->LodCount() << " LODs, "
+                << imported->GpuBytes() / 1024 << " KB on the GPU (" << ms << " ms)\n";
+        }
+    }
+
+
+    // World matrices are cached in the store and only rebuilt when an item moves
+    TransformStore transforms;
+
     struct RenderItem
     {
-        Transform transform;
+        TransformHandle transform;
         Mesh* mesh = nullptr;
+        bool isStatic = true; // never moves -> lives in the cached static shadow cube
     };
     std::vector<RenderItem> scene;
 
     // Cube 1
-    scene.push_back({ Transform{ glm::vec3(0,0,0), glm::vec3(0,0,0), glm::vec3(1,1,1) }, &cube });
-    // Cube 2 (offset)
-    scene.push_back({ Transform{ glm::vec3(2,0,0), glm::vec3(0,0,0), glm::vec3(1,1,1) }, &cube });
+    scene.push_back({ transforms.Create(Transform{ glm::vec3(0,0,0), glm::vec3(0,0,0), glm::vec3(1,1,1) }), &cube });
+    // Cube 2 (offset, rotates every frame)
+    scene.push_back({ transforms.Create(Transform{ glm::vec3(2,0,0), glm::vec3(0,0,0), glm::vec3(1,1,1) }), &cube, false });
     // Floor (just a scaled cube)
-    scene.push_back({ Transform{ glm::vec3(0,-1.0f,0), glm::vec3(0,0,0), glm::vec3(10.0f, 0.1f, 10.0f) }, &cube });
-
+    scene.push_back({ transforms.Create(Transform{ glm::vec3(0,-1.0f,0), glm::vec3(0,0,0), glm::vec3(10.0f, 0.1f, 10.0f) }), &cube });
 
+    // Imported mesh: fit into a 1.5 unit box standing on the floor, left of the cubes
+    if (imported)
+    {
+        const AABB& b = imported->Bounds();
+        glm::vec3 size = b.max - b.min;
+        float scale = 1.5f / std::max({ size.x, size.y, size.z, 1e-6f });
+        glm::vec3 center = (b.min + b.max) * 0.5f;
+        glm::vec3 pos = glm::vec3(-2.5f, -0.95f, 0.0f) - glm::vec3(center.x, b.min.y, center.z) * scale;
+        scene.push_back({ transforms.Create(Transform{ pos, glm::vec3(0,0,0), glm::vec3(scale) }), imported.get() });
+    }
 
-    GLint uModel = glGetUniformLocation(program.Id(), "uModel");
-    GLint uView = glGetUniformLocation(program.Id(), "uView");
-    GLint uProj = glGetUniformLocation(program.Id(), "uProj");
-    GLint uTex0 = glGetUniformLocation(program.Id(), "uTex0");   
-    GLint uCameraPosWS = glGetUniformLocation(program.Id(), "uCameraPosWS");
-    GLint uUseTexture = glGetUniformLocation(program.Id(), "uUseTexture");
-    GLint uLightPosWS = glGetUniformLocation(program.Id(), "uLightPosWS");
-    GLint uLightColor = glGetUniformLocation(program.Id(), "uLightColor");
-    GLint uIsLight = glGetUniformLocation(program.Id(), "uIsLight");
-    GLint uShadowCube = glGetUniformLocation(program.Id(), "uShadowCube");
-    GLint uFarPlane = glGetUniformLocation(program.Id(), "uFarPlane");
+    // Dynamic sheet in front of the cubes, its vertices rewritten every frame
+    MeshData waveData;
+    std::unique_ptr<Mesh> wave;
+    TransformHandle waveTransform = 0;
+    if (opt.wave > 0)
+    {
+        FillWaveGrid(waveData, opt.wave, 0.0f);
+        wave = std::make_unique<Mesh>(waveData);
+        waveTransform = transforms.Create(Transform{ glm::vec3(1.0f, -0.6f, 2.5f), glm::vec3(0,0,0), glm::vec3(3.0f, 1.0f, 3.0f) });
+        scene.push_back({ waveTransform, wave.get(), false });
+    }
 
-    GLint sh_uModel = glGetUniformLocation(shadowProg.Id(), "uModel");
-    GLint sh_uLightVP = glGetUniformLocation(shadowProg.Id(), "uLightVP");
-    GLint sh_uLightPos = glGetUniformLocation(shadowProg.Id(), "uLightPosWS");
-    GLint sh_uFarPlane = glGetUniformLocation(shadowProg.Id(), "uFarPlane");
+    // Optional field of cubes (or the imported mesh) spreading well past the camera and shadow far planes
+    Mesh* gridMesh = (opt.gridMesh && imported) ? imported.get() : &cube;
+    for (int z = 0; z < opt.grid; z++)
+    {
+        for (int x = 0; x < opt.grid; x++)
+        {
+            glm::vec3 pos((x - opt.grid * 0.5f) * 4.0f, -0.5f, (z - opt.grid * 0.5f) * 4.0f);
+            if (std::abs(pos.x) < 6.0f && std::abs(pos.z) < 6.0f)
+                continue; // keep the middle clear
+            scene.push_back({ transforms.Create(Transform{ pos, glm::vec3(0, 0.3f * (x + z), 0), glm::vec3(0.5f) }), gridMesh });
+        }
+    }
 
+    // Moving a static item has to drop the cached static shadows
+    std::vector<std::uint8_t> staticByHandle(transforms.Size(), 0);
+    for (const auto& item : scene)
+        staticByHandle[item.transform] = item.isStatic;
 
-    auto WarnIfMissing = [](GLint loc, const char* name)
+    // GPU-driven: the object list goes up once, culling and LOD selection run in a
+    // compute shader and each pass is one multi-draw per vertex layout
+    std::vector<std::uint32_t> itemByHandle(transforms.Size(), 0);
+    if (opt.gpuDriven)
+    {
+        gpuScene = std::make_unique<GpuScene>(std::string(ASSETS_DIR) + "/shaders");
+        if (!gpuScene->IsValid())
+        {
+            std::cerr << "Failed to create cull shader, using CPU culling.\n";
+            gpuScene.reset();
+        }
+        else
         {
-            if (loc == -1)
-                std::cerr << "Warning: " << name << " uniform not found (maybe optimized out).\n";
-        };  
-    WarnIfMissing(uTex0, "uTex0");
-    WarnIfMissing(uCameraPosWS, "uCameraPosWS");
-    WarnIfMissing(uModel, "uModel");
-    WarnIfMissing(uView, "uView");
-    WarnIfMissing(uProj, "uProj");
-    WarnIfMissing(uUseTexture, "uUseTexture");
-    WarnIfMissing(uLightPosWS, "uLightPosWS");
-    WarnIfMissing(uLightColor, "uLightColor");
-    WarnIfMissing(uShadowCube, "uShadowCube");
-    WarnIfMissing(uFarPlane, "uFarPlane");
+            transforms.Update();
+            std::vector<GpuSceneItem> items;
+            items.reserve(scene.size());
+            for (std::size_t i = 0; i < scene.size(); i++)
+            {
+                items.push_back({ scene[i].mesh, transforms.World(scene[i].transform), transforms.NormalMatrix(scene[i].transform) });
+                itemByHandle[scene[i].transform] = static_cast<std::uint32_t>(i);
+            }
+            gpuScene->Build(items);
+            std::cout << "[GPU] " << gpuScene->ObjectCount() << " objects uploaded\n";
+        }
+    }
+
+    // RenderItems grouped by mesh -> one instanced draw per mesh
+    InstanceBatcher sceneBatch;
+    InstanceBatcher gizmoBatch;
+
+
+
 
-    WarnIfMissing(sh_uModel, "sh_uModel");
-    WarnIfMissing(sh_uLightVP, "sh_uLightVP");
-    WarnIfMissing(sh_uLightPos, "sh_uLightPos");
-    WarnIfMissing(sh_uFarPlane, "sh_uFarPlane");
 
 
 
@@ -330,292 +669,412 @@ int main()
 
     bool wireframe = false;
     bool nearest = false;
+
+    bool wasPDown = false; // capture a profiler trace
+    int traceCount = 0;
+
+    bool wasGDown = false; // cycle shadow cube path
+    bool wasCDown = false; // shadow caching on/off
    
     // Basic render loop
-    while (!glfwWindowShouldClose(window))
+    auto KeepRunning = [&]()
+        {
+            if (window && glfwWindowShouldClose(window))
+                return false;
+            if (bench)
+                return !bench->IsDone();
+            return window != nullptr || frameIndex < opt.frames;
+        };
+
+    while (KeepRunning())
     {
-        glfwPollEvents();
+        if (bench) bench->BeginFrame();
+        GetRenderStats().Reset();
+        StreamBuffer::NextFrame();
 
+        Profiler::Get().BeginFrame();
+        PROFILE_SCOPE("Frame");
 
+        if (window)
+            glfwPollEvents();
 
-        float now = (float)glfwGetTime();
+        if (watcher)
+        {
+            for (const std::string& path : watcher->TakeChanges())
+            {
+                if (!textures.ReloadPath(path))
+                    BeginShaderReload(path);
+            }
+        }
+        lit.PollReload();
+        litUniform.PollReload();
+        shadowMap.PollShaders();
+        if (gpuScene)
+            gpuScene->PollShaders();
+        textures.Poll();
+
+        float now = GetTime();
         float dt = now - lastTime;
         lastTime = now;
 
-        double x, y;
-        glfwGetCursorPos(window, &x, &y);
+        // Mouse/keyboard only exist with a window; headless keeps the start camera
+        if (bench)
+        {
+            Benchmark::CameraAt(now, camPos, camFront);
+            lightPos = Benchmark::LightAt(now);
+        }
+        else if (window)
+        {
 
-        if (firstMouse) { lastX = x; lastY = y; firstMouse = false; }
+            double x, y;
+            glfwGetCursorPos(window, &x, &y);
 
-        float xoffset = (float)(x - lastX);
-        float yoffset = (float)(lastY - y);
-        lastX = x; lastY = y;
+            if (firstMouse) { lastX = x; lastY = y; firstMouse = false; }
 
-        float sensitivity = 0.08f;
-        xoffset *= sensitivity;
-        yoffset *= sensitivity;
+            float xoffset = (float)(x - lastX);
+            float yoffset = (float)(lastY - y);
+            lastX = x; lastY = y;
 
-        yaw += xoffset;
-        pitch += yoffset;
+            float sensitivity = 0.08f;
+            xoffset *= sensitivity;
+            yoffset *= sensitivity;
 
-        if (pitch > 89.0f) pitch = 89.0f;
-        if (pitch < -89.0f) pitch = -89.0f;
+            yaw += xoffset;
+            pitch += yoffset;
 
-        glm::vec3 front;
-        front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-        front.y = sin(glm::radians(pitch));
-        front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-        camFront = glm::normalize(front);
+            if (pitch > 89.0f) pitch = 89.0f;
+            if (pitch < -89.0f) pitch = -89.0f;
 
-        float speed = 3.0f * dt;
-        glm::vec3 right = glm::normalize(glm::cross(camFront, camUp));
+            glm::vec3 front;
+            front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+            front.y = sin(glm::radians(pitch));
+            front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+            camFront = glm::normalize(front);
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) camPos += camFront * speed;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camPos -= camFront * speed;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camPos += right * speed;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camPos -= right * speed;
+            float speed = 3.0f * dt;
+            glm::vec3 right = glm::normalize(glm::cross(camFront, camUp));
 
+            if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) camPos += camFront * speed;
+            if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camPos -= camFront * speed;
+            if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camPos += right * speed;
+            if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camPos -= right * speed;
 
 
 
 
-        bool isUDown = glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS;
-        if (isUDown && !wasUDown)
-        {
-            useTexture = 1 - useTexture;
-            std::cout << "[Mat] UseTexture: " << (useTexture ? "ON" : "OFF") << "\n";
-        }
-        wasUDown = isUDown;
 
-        bool isKDown = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
-        if (isKDown && !wasKDown)
-        {
-            anisoOn = !anisoOn;
-            tex.SetAnisotropy(anisoOn ? 16.0f : 1.0f);
-            std::cout << "[Tex] Aniso: " << (anisoOn ? "ON" : "OFF") << "\n";
-        }
-        wasKDown = isKDown;
+            bool isUDown = glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS;
+            if (isUDown && !wasUDown)
+            {
+                useTexture = 1 - useTexture;
+                std::cout << "[Mat] UseTexture: " << (useTexture ? "ON" : "OFF") << "\n";
+            }
+            wasUDown = isUDown;
 
-        bool isFDown = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
-        if (isFDown && !wasFDown)
-        {
-            nearest = !nearest;
+            bool isKDown = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
+            if (isKDown && !wasKDown)
+            {
+                anisoOn = !anisoOn;
+                textures.SetAnisotropy(tex, anisoOn ? 16.0f : 1.0f);
+                std::cout << "[Tex] Aniso: " << (anisoOn ? "ON" : "OFF") << "\n";
+            }
+            wasKDown = isKDown;
 
-            if (nearest)
+            bool isFDown = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+            if (isFDown && !wasFDown)
             {
-                // crisp pixels
-                tex.SetFiltering(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
-                std::cout << "[Tex] Filtering: NEAREST\n";
+                nearest = !nearest;
+
+                if (nearest)
+                {
+                    // crisp pixels
+                    textures.SetFiltering(tex, GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
+                    std::cout << "[Tex] Filtering: NEAREST\n";
+                }
+                else
+                {
+                    // smooth sampling
+                    textures.SetFiltering(tex, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+                    std::cout << "[Tex] Filtering: LINEAR\n";
+                }
             }
-            else
+            wasFDown = isFDown;
+
+            bool isLDown = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+            if (isLDown && !wasLDown)
             {
-                // smooth sampling
-                tex.SetFiltering(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-                std::cout << "[Tex] Filtering: LINEAR\n";
+                textures.Reload(tex);
             }
-        }
-        wasFDown = isFDown;
+            wasLDown = isLDown;
 
-        bool isLDown = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
-        if (isLDown && !wasLDown)
-        {
-            if (!tex.LoadFromFile(std::string(ASSETS_DIR) + "/textures/checker.png"))
-                std::cerr << "Texture reload failed.\n";
-        }
-        wasLDown = isLDown;
+            bool isRDown = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+            if (isRDown && !wasRDown)
+            {
+                BeginShaderReload({});
+            }
+            wasRDown = isRDown;
 
-        bool isRDown = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
-        if (isRDown && !wasRDown)
-        {
-            if (program.Reload())
-            {                             
-                uModel = glGetUniformLocation(program.Id(), "uModel");
-                uView = glGetUniformLocation(program.Id(), "uView");
-                uProj = glGetUniformLocation(program.Id(), "uProj");               
-                uTex0 = glGetUniformLocation(program.Id(), "uTex0");
-                uCameraPosWS = glGetUniformLocation(program.Id(), "uCameraPosWS");
-                uUseTexture = glGetUniformLocation(program.Id(), "uUseTexture");
-                uLightPosWS = glGetUniformLocation(program.Id(), "uLightPosWS");
-                uLightColor = glGetUniformLocation(program.Id(), "uLightColor");
-                uIsLight = glGetUniformLocation(program.Id(), "uIsLight");
-                uShadowCube = glGetUniformLocation(program.Id(), "uShadowCube");
-                uFarPlane = glGetUniformLocation(program.Id(), "uFarPlane");
-
-                sh_uModel = glGetUniformLocation(shadowProg.Id(), "uModel");
-                sh_uLightVP = glGetUniformLocation(shadowProg.Id(), "uLightVP");
-                sh_uLightPos = glGetUniformLocation(shadowProg.Id(), "uLightPosWS");
-                sh_uFarPlane = glGetUniformLocation(shadowProg.Id(), "uFarPlane");
-                             
-                WarnIfMissing(uTex0, "uTex0");
-                WarnIfMissing(uModel, "uModel");
-                WarnIfMissing(uView, "uView");
-                WarnIfMissing(uProj, "uProj");
-                WarnIfMissing(uCameraPosWS, "uCameraPosWS"); 
-                WarnIfMissing(uUseTexture, "uUseTexture");
-                WarnIfMissing(uLightPosWS, "uLightPosWS");
-                WarnIfMissing(uLightColor, "uLightColor");
-                WarnIfMissing(uIsLight, "uIsLight");
-                WarnIfMissing(uShadowCube, "uShadowCube");
-                WarnIfMissing(uFarPlane, "uFarPlane");
-
-                WarnIfMissing(sh_uModel, "sh_uModel");
-                WarnIfMissing(sh_uLightVP, "sh_uLightVP");
-                WarnIfMissing(sh_uLightPos, "sh_uLightPos");
-                WarnIfMissing(sh_uFarPlane, "sh_uFarPlane");
+            bool isPDown = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+            if (isPDown && !wasPDown)
+                Profiler::Get().StartCapture("trace_" + std::to_string(traceCount++) + ".json", 60);
+            wasPDown = isPDown;
+
+            bool isGDown = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+            if (isGDown && !wasGDown)
+            {
+                // per-face -> geometry shader -> vertex layer -> per-face, skipping unsupported
+                ShadowPath next = shadowMap.Path();
+                do
+                    next = static_cast<ShadowPath>((static_cast<int>(next) + 1) % 3);
+                while (!shadowMap.IsSupported(next));
+                shadowMap.SetPath(next);
+                std::cout << "[Shadow] Path: " << PointShadowMap::PathName(next) << "\n";
             }
-        }
-        wasRDown = isRDown;
+            wasGDown = isGDown;
 
-        bool isTDown = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
-        if (isTDown && !wasTDown)
-        {
-            wireframe = !wireframe;
-            glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
-        }
-        wasTDown = isTDown;
+            bool isCDown = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+            if (isCDown && !wasCDown)
+            {
+                shadowMap.SetCaching(!shadowMap.Caching());
+                std::cout << "[Shadow] Caching " << (shadowMap.Caching() ? "on" : "off") << "\n";
+            }
+            wasCDown = isCDown;
+
+            bool isTDown = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+            if (isTDown && !wasTDown)
+            {
+                wireframe = !wireframe;
+                glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+            }
+            wasTDown = isTDown;
 
-        
-        float lightSpeed = 3.0f * dt;
 
+            float lightSpeed = 3.0f * dt;
 
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) lightPos.x -= lightSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) lightPos.x += lightSpeed;
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) lightPos.z -= lightSpeed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) lightPos.z += lightSpeed;
 
-        if (glfwGetKey(window, GLFW_KEY_PAGE_UP) == GLFW_PRESS) lightPos.y += lightSpeed;
-        if (glfwGetKey(window, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS) lightPos.y -= lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) lightPos.x -= lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) lightPos.x += lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) lightPos.z -= lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) lightPos.z += lightSpeed;
+
+            if (glfwGetKey(window, GLFW_KEY_PAGE_UP) == GLFW_PRESS) lightPos.y += lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS) lightPos.y -= lightSpeed;
+        }
 
 
 
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
         glClearColor(0.01f, 0.15f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         int w = 0, h = 0;
-        glfwGetFramebufferSize(window, &w, &h);
+        GetFramebufferSize(w, h);
         float aspect = (h == 0) ? 1.0f : (static_cast<float>(w) / static_cast<float>(h));
                        
-        glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+        const float fovY = glm::radians(60.0f);
+        glm::mat4 proj = glm::perspective(fovY, aspect, 0.1f, 100.0f);
         glm::mat4 view = glm::lookAt(camPos, camPos + camFront, camUp);
 
 
 
 
 
-        glm::mat4 lightProj = glm::perspective(glm::radians(90.0f), 1.0f, SHADOW_NEAR, SHADOW_FAR);
-        glm::mat4 shadowVP[6] = {
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(1, 0, 0), glm::vec3(0,-1, 0)),
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1, 0, 0), glm::vec3(0,-1, 0)),
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(0, 1, 0), glm::vec3(0, 0, 1)),
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(0,-1, 0), glm::vec3(0, 0,-1)),
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(0, 0, 1), glm::vec3(0,-1, 0)),
-            lightProj * glm::lookAt(lightPos, lightPos + glm::vec3(0, 0,-1), glm::vec3(0,-1, 0)),
-        };
+        shadowMap.SetLight(lightPos);
 
-        glViewport(0, 0, SHADOW_SIZE, SHADOW_SIZE);
-        glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
+        CameraBlock cameraBlock;
+        cameraBlock.view = view;
+        cameraBlock.proj = proj;
+        cameraBlock.posWS = glm::vec4(camPos, 1.0f);
+        cameraUbo.Update(cameraBlock);
 
-        // Optional: reduce acne
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);
+        LightBlock lightBlock;
+        lightBlock.posWS = glm::vec4(lightPos, 1.0f);
+        lightBlock.color = glm::vec4(lightColor, 1.0f);
+        lightBlock.farPlane = shadowMap.FarPlane();
+        lightUbo.Update(lightBlock);
 
-        shadowProg.Use();
-        if (sh_uLightPos != -1) glUniform3fv(sh_uLightPos, 1, glm::value_ptr(lightPos));
-        if (sh_uFarPlane != -1) glUniform1f(sh_uFarPlane, SHADOW_FAR);
+        transforms.SetRotation(scene[1].transform, glm::vec3(0, now, 0)); // rotate cube 2
+        transforms.Update();
+        for (TransformHandle h : transforms.Updated())
+        {
+            if (staticByHandle[h])
+                shadowMap.InvalidateStaticCache();
+            if (gpuScene)
+                gpuScene->UpdateObject(itemByHandle[h], transforms.World(h), transforms.NormalMatrix(h));
+        }
 
-        for (int face = 0; face < 6; face++)
+        if (wave)
         {
-            if (sh_uLightVP != -1)
-                glUniformMatrix4fv(sh_uLightVP, 1, GL_FALSE, glm::value_ptr(shadowVP[face]));
+            // new bounds and dequantization come with the vertices
+            FillWaveGrid(waveData, opt.wave, now);
+            wave->UpdateVertices(waveData.vertices.data(), waveData.VertexCount());
+            if (gpuScene)
+                gpuScene->UpdateObject(itemByHandle[waveTransform], transforms.World(waveTransform), transforms.NormalMatrix(waveTransform));
+        }
+
+        // Cull every item against the camera and the 6 shadow faces separately:
+        // an object behind the camera can still cast a visible shadow
+        Frustum cameraFrustum = Frustum::FromViewProj(proj * view);
+        RenderStats& stats = GetRenderStats();
 
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, shadowCube, 0);
-            glClear(GL_DEPTH_BUFFER_BIT);
+        // LODs by screen-space error; shadows pick theirs from the light (so the cached
+        // static cube stays valid while the camera moves) and accept a coarser error
+        LodSelector cameraLod{ camPos, h / (2.0f * std::tan(fovY * 0.5f)), opt.lodError };
+        LodSelector shadowLod = shadowMap.MakeLodSelector(opt.shadowLodError);
 
+        sceneBatch.Clear();
+        if (gpuScene)
+        {
+            GpuCullParams cull{ cameraFrustum, cameraLod, {}, shadowLod };
+            for (int face = 0; face < 6; face++)
+                cull.shadowFaces[face] = shadowMap.FaceFrustum(face);
+            gpuScene->Cull(cull);
+        }
+        else
+        {
             for (auto& item : scene)
             {
-                // IMPORTANT: do NOT render the light gizmo cube into the shadow map
-                // (just skip that separate draw you do for the gizmo)
-                glm::mat4 model = MakeModelMatrix(item.transform);
-                if (sh_uModel != -1)
-                    glUniformMatrix4fv(sh_uModel, 1, GL_FALSE, glm::value_ptr(model));
-
-                item.mesh->Draw();
+                const glm::mat4& world = transforms.World(item.transform);
+                AABB bounds = item.mesh->Bounds().Transformed(world);
+
+                shadowMap.AddCaster(item.mesh, world, bounds, item.isStatic, shadowLod.Select(*item.mesh, world, bounds));
+
+                stats.cameraTested++;
+                if (!cameraFrustum.Intersects(bounds))
+                {
+                    stats.cameraCulled++;
+                    continue;
+                }
+                int lod = cameraLod.Select(*item.mesh, world, bounds);
+                stats.cameraLodReduced += lod > 0;
+                sceneBatch.Add(item.mesh, world,
+                    transforms.NormalMatrix(item.transform), transforms.HasUniformScale(item.transform), ~0u, lod);
             }
+            sceneBatch.Build();
         }
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-            
+        if (bench) bench->BeginPass(BenchPass::Shadow);
 
+        // IMPORTANT: do NOT render the light gizmo cube into the shadow map
+        // (it lives in its own batch, drawn only in the lit pass)
+        if (gpuScene)
+            shadowMap.RenderExternal([&]() { gpuScene->DrawShadow(); });
+        else
+            shadowMap.Render();
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
 
-        glfwGetFramebufferSize(window, &w, &h);
-        glViewport(0, 0, w, h);    
-       
-        program.Use();
-        tex.Bind(0);
+        if (bench)
+        {
+            bench->EndPass();
+            bench->BeginPass(BenchPass::Lit);
+        }
 
+            
 
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, shadowCube);
 
-        if (uShadowCube != -1) 
-            glUniform1i(uShadowCube, 1);
-        if (uFarPlane != -1) 
-            glUniform1f(uFarPlane, SHADOW_FAR);
+        GetFramebufferSize(w, h);
+        glViewport(0, 0, w, h);    
+       
+        textures.Bind(tex, 0);
 
+        GLState::Get().BindTexture(1, GL_TEXTURE_CUBE_MAP, shadowMap.CubeTexture());
 
+        auto UseLit = [&](const ShaderProgram& p)
+            {
+                p.Use();
+                glUniform1i(LIT_USE_TEXTURE_LOC, useTexture);
+                glUniform1i(LIT_IS_LIGHT_LOC, 0);
+            };
 
-        if (uTex0 != -1) 
-            glUniform1i(uTex0, 0);       
-        if (uView != -1)
-            glUniformMatrix4fv(uView, 1, GL_FALSE, glm::value_ptr(view));
-        if (uProj != -1)
-            glUniformMatrix4fv(uProj, 1, GL_FALSE, glm::value_ptr(proj));            
-        if (uUseTexture != -1)
-            glUniform1i(uUseTexture, useTexture);
+        {
+            PROFILE_SCOPE("LitScene");
+            if (gpuScene)
+            {
+                // every object through the general variant (reads the normal matrix)
+                UseLit(lit);
+                gpuScene->DrawLit();
+            }
+            else if (sceneBatch.HasBatches(ScaleFilter::NonUniform))
+            {
+                UseLit(lit);
+                sceneBatch.Draw(ScaleFilter::NonUniform);
+            }
+            // uniform-scale variant stays bound for the gizmo below
+            UseLit(litUniform);
+            sceneBatch.Draw(ScaleFilter::Uniform);
+        }
 
-        if (uLightPosWS != -1) 
-            glUniform3fv(uLightPosWS, 1, glm::value_ptr(lightPos));
-        if (uLightColor != -1) 
-            glUniform3fv(uLightColor, 1, glm::value_ptr(lightColor));
-        if (uCameraPosWS != -1) 
-            glUniform3fv(uCameraPosWS, 1, glm::value_ptr(camPos));
 
+        glm::mat4 lightModel(1.0f);
+        lightModel = glm::translate(lightModel, lightPos);
+        lightModel = glm::scale(lightModel, glm::vec3(0.12f)); // small cube
 
-        scene[1].transform.rotationEuler.y = (float)glfwGetTime(); // rotate cube 2
-        if (uIsLight != -1) glUniform1i(uIsLight, 0);
+        gizmoBatch.Clear();
+        gizmoBatch.Add(&cube, lightModel);
+        gizmoBatch.Build();
 
-        for (auto& item : scene)
-        {
-            glm::mat4 model = MakeModelMatrix(item.transform);
+        glUniform1i(LIT_IS_LIGHT_LOC, 1);
 
-            if (uModel != -1)
-                glUniformMatrix4fv(uModel, 1, GL_FALSE, glm::value_ptr(model));
+        gizmoBatch.Draw();
 
-            item.mesh->Draw();
-        }
+        glUniform1i(LIT_IS_LIGHT_LOC, 0);
 
+        if (bench) bench->EndPass();
 
-        glm::mat4 lightModel(1.0f);
-        lightModel = glm::translate(lightModel, lightPos);
-        lightModel = glm::scale(lightModel, glm::vec3(0.12f)); // small cube
 
-        if (uModel != -1) 
-            glUniformMatrix4fv(uModel, 1, GL_FALSE, glm::value_ptr(lightModel));
-        if (uIsLight != -1) 
-            glUniform1i(uIsLight, 1);
+        if (window)
+            glfwSwapBuffers(window);
 
-        cube.Draw();
+        if (bench) bench->EndFrame(GetRenderStats());
+        frameIndex++;
+    }
 
-        if (uIsLight != -1) glUniform1i(uIsLight, 0);
+    if (bench)
+        bench->Finish();
 
+#if MINIRENDERER_HEADLESS
+    if (opt.headless)
+    {
+        glFinish();
+        std::cout << "[Headless] Rendered " << frameIndex << " frames ("
+            << opt.width << "x" << opt.height << ")\n";
+
+        const RenderStats& stats = GetRenderStats();
+        std::cout << "[Cull] camera " << stats.cameraCulled << "/" << stats.cameraTested
+            << " culled, shadow " << stats.shadowCulled << "/" << stats.shadowTested
+            << " culled, " << stats.shadowFaces << " shadow faces drawn\n";
+        std::cout << "[LOD] below LOD 0: camera " << stats.cameraLodReduced << ", shadow " << stats.shadowLodReduced
+            << ", " << stats.triangles << " triangles in the last frame\n";
+
+        if (gpuScene)
+        {
+            GpuCullStats gpuStats = gpuScene->ReadStats();
+            std::cout << "[GPU] last frame: " << gpuStats.cameraVisible << "/" << gpuScene->ObjectCount() << " visible ("
+                << gpuStats.cameraLodReduced << " below LOD 0, " << gpuStats.triangles << " triangles), "
+                << gpuStats.shadowCasters << " casters in " << gpuStats.shadowFaces << " shadow faces, "
+                << stats.drawCalls << " draw calls for " << stats.indirectCommands << " indirect draws\n";
+        }
 
-        glfwSwapBuffers(window);
+        GeometryStats geoStats = GeometryArena::Get().Stats();
+        std::cout << "[Geo] " << geoStats.meshes << " meshes in " << geoStats.pools << " pools, "
+            << geoStats.usedBytes / 1024 << "/" << geoStats.capacityBytes / 1024 << " KB used, "
+            << geoStats.repacks << " repacks, " << stats.vertexArrayBinds << " VAO binds in the last frame\n";
+        std::cout << "[State] last frame: " << stats.stateCallsIssued << " GL state calls issued, "
+            << stats.stateCallsElided << " elided as redundant\n";
+        std::cout << "[Stream] last frame: " << stats.streamBytes / 1024 << " KB written to persistent-mapped rings, "
+            << stats.streamWaits << " fence waits\n";
+
+        TextureStats texStats = textures.Stats();
+        std::cout << "[Tex] " << texStats.resident << "/" << texStats.textures << " resident, "
+            << texStats.residentBytes / 1024 << " KB (peak " << texStats.peakBytes / 1024 << " KB, budget "
+            << texStats.budgetBytes / (1024 * 1024) << " MB), " << texStats.evictions << " evictions, "
+            << texStats.mipDrops << " mip drops\n";
+
+        if (!opt.outPath.empty() && !headless.SaveFramePPM(opt.outPath))
+            std::cerr << "Failed to write frame: " << opt.outPath << "\n";
     }
+#endif
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    Shutdown();
     return 0;
 }
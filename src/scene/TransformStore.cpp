@@ -0,0 +1,133 @@
+#include "TransformStore.h"
+#include <algorithm>
+#include <cmath>
+
+TransformHandle TransformStore::Create(const Transform& t)
+{
+    TransformHandle h = static_cast<TransformHandle>(m_world.size());
+
+    m_posX.push_back(t.position.x); m_posY.push_back(t.position.y); m_posZ.push_back(t.position.z);
+    m_rotX.push_back(t.rotationEuler.x); m_rotY.push_back(t.rotationEuler.y); m_rotZ.push_back(t.rotationEuler.z);
+    m_sclX.push_back(t.scale.x); m_sclY.push_back(t.scale.y); m_sclZ.push_back(t.scale.z);
+
+    m_world.emplace_back(1.0f);
+    m_normal.emplace_back(1.0f);
+    m_dirty.push_back(0);
+    MarkDirty(h);
+    return h;
+}
+
+Transform TransformStore::Get(TransformHandle h) const
+{
+    Transform t;
+    t.position = glm::vec3(m_posX[h], m_posY[h], m_posZ[h]);
+    t.rotationEuler = glm::vec3(m_rotX[h], m_rotY[h], m_rotZ[h]);
+    t.scale = glm::vec3(m_sclX[h], m_sclY[h], m_sclZ[h]);
+    return t;
+}
+
+void TransformStore::Set(TransformHandle h, const Transform& t)
+{
+    SetPosition(h, t.position);
+    SetRotation(h, t.rotationEuler);
+    SetScale(h, t.scale);
+}
+
+void TransformStore::SetPosition(TransformHandle h, const glm::vec3& p)
+{
+    if (m_posX[h] == p.x && m_posY[h] == p.y && m_posZ[h] == p.z) return;
+    m_posX[h] = p.x; m_posY[h] = p.y; m_posZ[h] = p.z;
+    MarkDirty(h);
+}
+
+void TransformStore::SetRotation(TransformHandle h, const glm::vec3& r)
+{
+    if (m_rotX[h] == r.x && m_rotY[h] == r.y && m_rotZ[h] == r.z) return;
+    m_rotX[h] = r.x; m_rotY[h] = r.y; m_rotZ[h] = r.z;
+    MarkDirty(h);
+}
+
+void TransformStore::SetScale(TransformHandle h, const glm::vec3& s)
+{
+    if (m_sclX[h] == s.x && m_sclY[h] == s.y && m_sclZ[h] == s.z) return;
+    m_sclX[h] = s.x; m_sclY[h] = s.y; m_sclZ[h] = s.z;
+    MarkDirty(h);
+}
+
+bool TransformStore::HasUniformScale(TransformHandle h) const
+{
+    const float eps = 1e-5f * std::max({ std::abs(m_sclX[h]), std::abs(m_sclY[h]), std::abs(m_sclZ[h]) });
+    return std::abs(m_sclX[h] - m_sclY[h]) <= eps && std::abs(m_sclX[h] - m_sclZ[h]) <= eps;
+}
+
+void TransformStore::MarkDirty(TransformHandle h)
+{
+    if (m_dirty[h]) return;
+    m_dirty[h] = 1;
+    m_dirtyList.push_back(h);
+}
+
+std::size_t TransformStore::Update()
+{
+    m_updated.clear();
+    if (m_dirtyList.empty())
+        return 0;
+
+    // Ascending order keeps the gathers/scatters mostly sequential
+    std::sort(m_dirtyList.begin(), m_dirtyList.end());
+
+    // Gather a block into local SoA lanes, do the math branch-free over the lanes
+    // (vectorizes cleanly), then scatter the finished matrices.
+    constexpr std::size_t BLOCK = 64;
+    float cx[BLOCK], sx[BLOCK], cy[BLOCK], sy[BLOCK], cz[BLOCK], sz[BLOCK];
+
+    for (std::size_t base = 0; base < m_dirtyList.size(); base += BLOCK)
+    {
+        const std::size_t n = std::min(BLOCK, m_dirtyList.size() - base);
+        const TransformHandle* ids = m_dirtyList.data() + base;
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const TransformHandle h = ids[i];
+            cx[i] = std::cos(m_rotX[h]); sx[i] = std::sin(m_rotX[h]);
+            cy[i] = std::cos(m_rotY[h]); sy[i] = std::sin(m_rotY[h]);
+            cz[i] = std::cos(m_rotZ[h]); sz[i] = std::sin(m_rotZ[h]);
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const TransformHandle h = ids[i];
+            const float kx = m_sclX[h], ky = m_sclY[h], kz = m_sclZ[h];
+
+            // Columns of Rx*Ry*Rz, each scaled by its axis scale
+            glm::mat4& M = m_world[h];
+            M[0] = glm::vec4(cy[i] * cz[i] * kx,
+                (cx[i] * sz[i] + sx[i] * sy[i] * cz[i]) * kx,
+                (sx[i] * sz[i] - cx[i] * sy[i] * cz[i]) * kx,
+                0.0f);
+            M[1] = glm::vec4(-cy[i] * sz[i] * ky,
+                (cx[i] * cz[i] - sx[i] * sy[i] * sz[i]) * ky,
+                (sx[i] * cz[i] + cx[i] * sy[i] * sz[i]) * ky,
+                0.0f);
+            M[2] = glm::vec4(sy[i] * kz,
+                -sx[i] * cy[i] * kz,
+                cx[i] * cy[i] * kz,
+                0.0f);
+            M[3] = glm::vec4(m_posX[h], m_posY[h], m_posZ[h], 1.0f);
+
+            // inverse transpose of R*S is R*S^-1: rotation columns over scale
+            // = world columns over scale squared; no general 3x3 inverse needed
+            const float ix = 1.0f / (kx * kx), iy = 1.0f / (ky * ky), iz = 1.0f / (kz * kz);
+            glm::mat3& N = m_normal[h];
+            N[0] = glm::vec3(M[0].x * ix, M[0].y * ix, M[0].z * ix);
+            N[1] = glm::vec3(M[1].x * iy, M[1].y * iy, M[1].z * iy);
+            N[2] = glm::vec3(M[2].x * iz, M[2].y * iz, M[2].z * iz);
+
+            m_dirty[h] = 0;
+        }
+    }
+
+    m_updated.swap(m_dirtyList);
+    m_dirtyList.clear();
+    return m_updated.size();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct Transform
+{
+    glm::vec3 position{ 0.0f };
+    glm::vec3 rotationEuler{ 0.0f }; // radians: x,y,z
+    glm::vec3 scale{ 1.0f };
+};
+
+using TransformHandle = std::uint32_t;
+
+// Owns every object transform. Components are stored SoA (one float array per
+// component) and world matrices are cached; Update() rebuilds only the entries
+// touched since the last update, in blocks laid out for auto-vectorization.
+// World = T * Rx * Ry * Rz * S (same convention the per-item glm::rotate chain used).
+// The normal matrix (inverse transpose of the upper 3x3) is cached next to it.
+class TransformStore
+{
+public:
+    TransformHandle Create(const Transform& t);
+    std::size_t Size() const { return m_world.size(); }
+
+    Transform Get(TransformHandle h) const;
+    void Set(TransformHandle h, const Transform& t);
+    void SetPosition(TransformHandle h, const glm::vec3& p);
+    void SetRotation(TransformHandle h, const glm::vec3& eulerRadians);
+    void SetScale(TransformHandle h, const glm::vec3& s);
+
+    // Recomputes dirty world matrices. Returns how many were rebuilt.
+    std::size_t Update();
+
+    // Valid after Update(); stable reference until the next Create()
+    const glm::mat4& World(TransformHandle h) const { return m_world[h]; }
+    const std::vector<glm::mat4>& WorldMatrices() const { return m_world; }
+    const glm::mat3& NormalMatrix(TransformHandle h) const { return m_normal[h]; }
+
+    // Uniform scale: mat3(World) is a scaled rotation, so normals need no inverse
+    bool HasUniformScale(TransformHandle h) const;
+
+    // Handles rebuilt by the last Update() (for caches keyed on movement)
+    const std::vector<TransformHandle>& Updated() const { return m_updated; }
+
+private:
+    void MarkDirty(TransformHandle h);
+
+    // SoA components
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_rotX, m_rotY, m_rotZ;
+    std::vector<float> m_sclX, m_sclY, m_sclZ;
+
+    std::vector<glm::mat4> m_world;
+    std::vector<glm::mat3> m_normal;
+    std::vector<std::uint8_t> m_dirty;
+    std::vector<TransformHandle> m_dirtyList;
+    std::vector<TransformHandle> m_updated;
+};
@@ -0,0 +1,382 @@
+#include "BcnEncoder.h"
+#include "gfx/CookedTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    int Clamp(int v, int lo, int hi) { return std::min(std::max(v, lo), hi); }
+
+    // Endpoints along the principal axis of the block (first `channels` of RGBA)
+    void PrincipalEndpoints(const unsigned char* px, int channels, float lo[4], float hi[4])
+    {
+        float mean[4] = {};
+        float mn[4] = { 255, 255, 255, 255 };
+        float mx[4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                float v = px[i * 4 + c];
+                mean[c] += v / 16.0f;
+                mn[c] = std::min(mn[c], v);
+                mx[c] = std::max(mx[c], v);
+            }
+        }
+
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float d[4] = {};
+            for (int c = 0; c < channels; c++)
+                d[c] = px[i * 4 + c] - mean[c];
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    cov[a][b] += d[a] * d[b];
+        }
+
+        // power iteration, starting from the bounding box diagonal
+        float axis[4] = {};
+        for (int c = 0; c < channels; c++)
+            axis[c] = mx[c] - mn[c];
+        for (int it = 0; it < 8; it++)
+        {
+            float next[4] = {};
+            float len = 0.0f;
+            for (int a = 0; a < channels; a++)
+            {
+                for (int b = 0; b < channels; b++)
+                    next[a] += cov[a][b] * axis[b];
+                len += next[a] * next[a];
+            }
+            if (len < 1e-6f)
+                break;
+            len = std::sqrt(len);
+            for (int c = 0; c < channels; c++)
+                axis[c] = next[c] / len;
+        }
+
+        float len = 0.0f;
+        for (int c = 0; c < channels; c++)
+            len += axis[c] * axis[c];
+        if (len < 1e-6f)
+        {
+            // flat block
+            for (int c = 0; c < 4; c++)
+                lo[c] = hi[c] = mean[c];
+            return;
+        }
+        len = std::sqrt(len);
+        for (int c = 0; c < channels; c++)
+            axis[c] /= len;
+
+        float tMin = 1e9f, tMax = -1e9f;
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < channels; c++)
+                t += (px[i * 4 + c] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+
+        // pull the ends in by 1/16 of the range: the extremes rarely need exact hits
+        float inset = (tMax - tMin) / 16.0f;
+        tMin += inset;
+        tMax -= inset;
+
+        for (int c = 0; c < 4; c++)
+        {
+            lo[c] = std::min(std::max(mean[c] + tMin * axis[c], 0.0f), 255.0f);
+            hi[c] = std::min(std::max(mean[c] + tMax * axis[c], 0.0f), 255.0f);
+        }
+    }
+
+    int Distance(const unsigned char* px, const int* color, int channels)
+    {
+        int d = 0;
+        for (int c = 0; c < channels; c++)
+            d += (px[c] - color[c]) * (px[c] - color[c]);
+        return d;
+    }
+
+    std::uint16_t To565(const float c[3])
+    {
+        int r = Clamp(static_cast<int>(c[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = Clamp(static_cast<int>(c[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = Clamp(static_cast<int>(c[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void From565(std::uint16_t v, int out[3])
+    {
+        int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+        out[0] = (r << 3) | (r >> 2);
+        out[1] = (g << 2) | (g >> 4);
+        out[2] = (b << 3) | (b >> 2);
+    }
+
+    // 4-colour BC1 block (also the colour half of BC3)
+    void EncodeColorBlock(const unsigned char rgba[64], unsigned char out[8])
+    {
+        float lo[4], hi[4];
+        PrincipalEndpoints(rgba, 3, lo, hi);
+
+        std::uint16_t c0 = To565(hi), c1 = To565(lo);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        std::uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            int palette[4][3];
+            From565(c0, palette[0]);
+            From565(c1, palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0, bestDist = Distance(rgba + i * 4, palette[0], 3);
+                for (int k = 1; k < 4; k++)
+                {
+                    int d = Distance(rgba + i * 4, palette[k], 3);
+                    if (d < bestDist)
+                    {
+                        best = k;
+                        bestDist = d;
+                    }
+                }
+                indices |= static_cast<std::uint32_t>(best) << (2 * i);
+            }
+        }
+        // c0 == c1: every index 0 is already right
+
+        out[0] = c0 & 0xFF;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF;
+        out[3] = c1 >> 8;
+        for (int b = 0; b < 4; b++)
+            out[4 + b] = (indices >> (8 * b)) & 0xFF;
+    }
+
+    // 8-value BC3 alpha block
+    void EncodeAlphaBlock(const unsigned char rgba[64], unsigned char out[8])
+    {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            a0 = std::max<int>(a0, rgba[i * 4 + 3]);
+            a1 = std::min<int>(a1, rgba[i * 4 + 3]);
+        }
+
+        std::uint64_t indices = 0;
+        if (a0 != a1)
+        {
+            int palette[8] = { a0, a1 };
+            for (int k = 1; k < 7; k++)
+                palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+
+            for (int i = 0; i < 16; i++)
+            {
+                int a = rgba[i * 4 + 3];
+                int best = 0;
+                for (int k = 1; k < 8; k++)
+                {
+                    if (std::abs(a - palette[k]) < std::abs(a - palette[best]))
+                        best = k;
+                }
+                indices |= static_cast<std::uint64_t>(best) << (3 * i);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+        for (int b = 0; b < 6; b++)
+            out[2 + b] = (indices >> (8 * b)) & 0xFF;
+    }
+
+    // 7-bit endpoint + shared p-bit, whichever p-bit lands closer
+    void QuantizeBC7Endpoint(const float v[4], int q[4], int& pbit)
+    {
+        float bestErr = 1e30f;
+        for (int p = 0; p < 2; p++)
+        {
+            int cand[4];
+            float err = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                cand[c] = Clamp(static_cast<int>((v[c] - p) / 2.0f + 0.5f), 0, 127);
+                float d = static_cast<float>((cand[c] << 1) | p) - v[c];
+                err += d * d;
+            }
+            if (err < bestErr)
+            {
+                bestErr = err;
+                pbit = p;
+                std::memcpy(q, cand, sizeof(cand));
+            }
+        }
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(unsigned char* out, std::size_t bytes) : m_out(out) { std::memset(out, 0, bytes); }
+
+        void Put(std::uint32_t value, int count)
+        {
+            for (int b = 0; b < count; b++, m_pos++)
+            {
+                if ((value >> b) & 1)
+                    m_out[m_pos >> 3] |= static_cast<unsigned char>(1 << (m_pos & 7));
+            }
+        }
+
+    private:
+        unsigned char* m_out;
+        int m_pos = 0;
+    };
+}
+
+void EncodeBC1Block(const unsigned char rgba[64], unsigned char out[8])
+{
+    EncodeColorBlock(rgba, out);
+}
+
+void EncodeBC3Block(const unsigned char rgba[64], unsigned char out[16])
+{
+    EncodeAlphaBlock(rgba, out);
+    EncodeColorBlock(rgba, out + 8);
+}
+
+void EncodeBC7Block(const unsigned char rgba[64], unsigned char out[16])
+{
+    static const int WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float lo[4], hi[4];
+    PrincipalEndpoints(rgba, 4, lo, hi);
+
+    int e[2][4];
+    int pbit[2] = {};
+    QuantizeBC7Endpoint(lo, e[0], pbit[0]);
+    QuantizeBC7Endpoint(hi, e[1], pbit[1]);
+
+    int palette[16][4];
+    for (int k = 0; k < 16; k++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            int a = (e[0][c] << 1) | pbit[0];
+            int b = (e[1][c] << 1) | pbit[1];
+            palette[k][c] = ((64 - WEIGHTS[k]) * a + WEIGHTS[k] * b + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; i++)
+    {
+        int best = 0, bestDist = Distance(rgba + i * 4, palette[0], 4);
+        for (int k = 1; k < 16; k++)
+        {
+            int d = Distance(rgba + i * 4, palette[k], 4);
+            if (d < bestDist)
+            {
+                best = k;
+                bestDist = d;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // the anchor (texel 0) index is stored with its top bit implied 0
+    if (indices[0] & 8)
+    {
+        std::swap(e[0], e[1]);
+        std::swap(pbit[0], pbit[1]);
+        for (int& index : indices)
+            index = 15 - index;
+    }
+
+    BitWriter bits(out, 16);
+    bits.Put(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; c++)
+    {
+        bits.Put(e[0][c], 7);
+        bits.Put(e[1][c], 7);
+    }
+    bits.Put(pbit[0], 1);
+    bits.Put(pbit[1], 1);
+    for (int i = 0; i < 16; i++)
+        bits.Put(indices[i], i == 0 ? 3 : 4);
+}
+
+ImageData CompressWithMips(const ImageData& image, GLenum format)
+{
+    ImageData out;
+    out.width = image.width;
+    out.height = image.height;
+    out.channels = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 3 : 4;
+    out.format = format;
+
+    // work in RGBA8 throughout
+    ImageData level;
+    level.width = image.width;
+    level.height = image.height;
+    level.channels = 4;
+    level.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(image.width) * image.height; i++)
+    {
+        for (int c = 0; c < 4; c++)
+            level.pixels[i * 4 + c] = c < image.channels ? image.pixels[i * image.channels + c] : 255;
+    }
+
+    const unsigned blockBytes = CompressedBlockBytes(format);
+    for (;;)
+    {
+        ImageLevel info;
+        info.width = level.width;
+        info.height = level.height;
+        info.offset = out.pixels.size();
+
+        for (int by = 0; by < level.height; by += 4)
+        {
+            for (int bx = 0; bx < level.width; bx += 4)
+            {
+                // edge blocks repeat the last row / column
+                unsigned char block[64];
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int sx = std::min(bx + x, level.width - 1), sy = std::min(by + y, level.height - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, &level.pixels[(static_cast<std::size_t>(sy) * level.width + sx) * 4], 4);
+                    }
+                }
+
+                unsigned char encoded[16];
+                if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+                    EncodeBC1Block(block, encoded);
+                else if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+                    EncodeBC3Block(block, encoded);
+                else
+                    EncodeBC7Block(block, encoded);
+                out.pixels.insert(out.pixels.end(), encoded, encoded + blockBytes);
+            }
+        }
+
+        info.size = out.pixels.size() - info.offset;
+        out.levels.push_back(info);
+
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = level.HalfSize();
+    }
+    return out;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <glad/glad.h>
+#include "gfx/ImageData.h"
+
+// CPU block compression for TexCook. A block is 4x4 RGBA8 texels, row by row.
+// Endpoints come from the principal axis of the block's colours (inset a little),
+// indices are the nearest palette entry: fast and decent, not a quality encoder.
+void EncodeBC1Block(const unsigned char rgba[64], unsigned char out[8]);
+void EncodeBC3Block(const unsigned char rgba[64], unsigned char out[16]);
+void EncodeBC7Block(const unsigned char rgba[64], unsigned char out[16]); // mode 6 only
+
+// Box-filtered mip chain of a raw image (3 or 4 channels) down to 1x1, every level
+// compressed to format. The result is ready for WriteCookedTexture.
+ImageData CompressWithMips(const ImageData& image, GLenum format);
@@ -0,0 +1,111 @@
+// MeshCook: OBJ/GLB -> .cmesh (GPU-ready vertex/index blobs), see CookedMesh.h
+#include "gfx/CookedMesh.h"
+#include "gfx/MeshImporter.h"
+#include "gfx/MeshOptimizer.h"
+#include "gfx/MeshSimplifier.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct CookOptions
+{
+    VertexLayout layout; // compact by default
+    int lods = MAX_MESH_LODS; // levels incl. LOD 0
+    std::vector<std::string> inputs;
+};
+
+static bool ParseArgs(int argc, char** argv, CookOptions& opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--positions") == 0 && hasValue)
+        {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "float") == 0) opt.layout.position = PositionFormat::Float3;
+            else if (std::strcmp(name, "half") == 0) opt.layout.position = PositionFormat::Half3;
+            else if (std::strcmp(name, "unorm16") == 0) opt.layout.position = PositionFormat::Unorm16;
+            else return false;
+        }
+        else if (std::strcmp(arg, "--uvs") == 0 && hasValue)
+        {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "float") == 0) opt.layout.uv = UvFormat::Float2;
+            else if (std::strcmp(name, "half") == 0) opt.layout.uv = UvFormat::Half2;
+            else return false;
+        }
+        else if (std::strcmp(arg, "--lods") == 0 && hasValue)
+        {
+            opt.lods = std::atoi(argv[++i]);
+            if (opt.lods < 1 || opt.lods > MAX_MESH_LODS)
+                return false;
+        }
+        else if (arg[0] == '-')
+            return false;
+        else
+            opt.inputs.push_back(arg);
+    }
+    return !opt.inputs.empty();
+}
+
+int main(int argc, char** argv)
+{
+    CookOptions opt;
+    if (!ParseArgs(argc, argv, opt))
+    {
+        std::cerr << "Usage: MeshCook [--positions float|half|unorm16] [--uvs float|half] [--lods 1-" << MAX_MESH_LODS << "] model.obj|model.glb [more models...]\n"
+            << "Writes model" << COOKED_MESH_EXT << " next to each input (default: unorm16 positions, half uvs, " << MAX_MESH_LODS << " LODs).\n";
+        return 1;
+    }
+
+    int failed = 0;
+    for (const std::string& input : opt.inputs)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        MeshData data;
+        if (!ImportMesh(input, data))
+        {
+            failed++;
+            continue;
+        }
+
+        VertexCacheStats before, after;
+        OptimizeMesh(data, &before, &after);
+        GenerateLods(data, opt.lods);
+        PackedMesh packed = PackMesh(data, opt.layout);
+
+        std::string output = std::filesystem::path(input).replace_extension(COOKED_MESH_EXT).string();
+        if (!WriteCookedMesh(output, packed))
+        {
+            failed++;
+            continue;
+        }
+
+        // what the float layout would take: 32-byte vertices, 32-bit indices for every LOD
+        // (packed.indices holds all the LOD slices too)
+        std::size_t floatIndices = data.indices.size();
+        for (const MeshLodData& lod : data.lods)
+            floatIndices += lod.indices.size();
+        std::size_t floatBytes = data.vertices.size() * sizeof(float) + floatIndices * sizeof(unsigned int);
+        std::size_t packedBytes = packed.positions.size() + packed.attributes.size() + packed.indices.size();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << input << " -> " << output << " (" << data.VertexCount() << " verts, "
+            << data.TriangleCount() << " tris, " << floatBytes / 1024 << " KB -> " << packedBytes / 1024 << " KB, "
+            << (packed.indexType == GL_UNSIGNED_SHORT ? "16" : "32") << "-bit indices, " << ms << " ms)\n"
+            << "  ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+        for (std::size_t i = 0; i < data.lods.size(); i++)
+        {
+            std::cout << "  LOD " << i + 1 << ": " << data.lods[i].indices.size() / 3 << " tris, error "
+                << data.lods[i].error << "\n";
+        }
+    }
+
+    return failed == 0 ? 0 : 1;
+}
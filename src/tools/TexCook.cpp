@@ -0,0 +1,96 @@
+// TexCook: PNG/JPG/TGA -> .ctex (BCn blocks + full mip chain), see CookedTexture.h
+#include "BcnEncoder.h"
+#include "gfx/CookedTexture.h"
+#include "gfx/ImageData.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct CookOptions
+{
+    GLenum format = 0; // 0 = BC1 when opaque, BC3 otherwise
+    std::vector<std::string> inputs;
+};
+
+static bool ParseArgs(int argc, char** argv, CookOptions& opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--format") == 0 && hasValue)
+        {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "bc1") == 0) opt.format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            else if (std::strcmp(name, "bc3") == 0) opt.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            else if (std::strcmp(name, "bc7") == 0) opt.format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            else return false;
+        }
+        else if (arg[0] == '-')
+            return false;
+        else
+            opt.inputs.push_back(arg);
+    }
+    return !opt.inputs.empty();
+}
+
+static bool IsOpaque(const ImageData& image)
+{
+    if (image.channels == 3)
+        return true;
+    for (std::size_t i = 3; i < image.pixels.size(); i += 4)
+    {
+        if (image.pixels[i] != 255)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    CookOptions opt;
+    if (!ParseArgs(argc, argv, opt))
+    {
+        std::cerr << "Usage: TexCook [--format bc1|bc3|bc7] image.png [more images...]\n"
+            << "Writes image" << COOKED_TEXTURE_EXT << " next to each input (default format: BC1 if opaque, else BC3).\n";
+        return 1;
+    }
+
+    int failed = 0;
+    for (const std::string& input : opt.inputs)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        ImageData image;
+        if (!DecodeImage(input, image))
+        {
+            failed++;
+            continue;
+        }
+
+        GLenum format = opt.format;
+        if (format == 0)
+            format = IsOpaque(image) ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+        ImageData cooked = CompressWithMips(image, format);
+        std::string output = std::filesystem::path(input).replace_extension(COOKED_TEXTURE_EXT).string();
+        if (!WriteCookedTexture(output, cooked))
+        {
+            failed++;
+            continue;
+        }
+
+        // what the runtime would have allocated: RGB8/RGBA8 plus a third for the mips
+        std::size_t rawBytes = image.pixels.size() * 4 / 3;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << input << " -> " << output << " (" << CompressedFormatName(format) << ", "
+            << image.width << "x" << image.height << ", " << cooked.levels.size() << " levels, "
+            << rawBytes / 1024 << " KB -> " << cooked.pixels.size() / 1024 << " KB, " << ms << " ms)\n";
+    }
+
+    return failed == 0 ? 0 : 1;
+}